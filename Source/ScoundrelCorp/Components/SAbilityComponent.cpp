@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAbilityComponent.h"
+#include "SClockSyncComponent.h"
+#include "Net/UnrealNetwork.h"
+
+// Sets default values for this component's properties
+USAbilityComponent::USAbilityComponent()
+{
+	ServerCooldownTolerance = 0.1f;
+
+	// Dallas's snap and the dodge roll, character blueprints can override these
+	Abilities.Add(FSAbilityDefinition(TEXT("Snap"), 10.0f));
+	Abilities.Add(FSAbilityDefinition(TEXT("DodgeRoll"), 1.5f));
+
+	SetIsReplicated(true);
+}
+
+
+// Called when the game starts
+void USAbilityComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// every ability starts ready, unless the owner already received the server's cooldowns
+	if (CooldownEndTimes.Num() != Abilities.Num())
+	{
+		CooldownEndTimes.Init(0.0f, Abilities.Num());
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		float ShortestCooldown = BIG_NUMBER;
+		for (const FSAbilityDefinition& Ability : Abilities)
+		{
+			ShortestCooldown = FMath::Min(ShortestCooldown, Ability.Cooldown);
+		}
+
+		// every ability may come in back to back once, after that the fastest cooldown sets the pace
+		ActivateRateLimit.Configure(1.0f / FMath::Clamp(ShortestCooldown, 0.1f, 60.0f), Abilities.Num() + 1.0f);
+	}
+}
+
+int32 USAbilityComponent::FindAbilityIndex(FName AbilityName) const
+{
+	return Abilities.IndexOfByPredicate([AbilityName](const FSAbilityDefinition& Ability)
+	{
+		return Ability.AbilityName == AbilityName;
+	});
+}
+
+float USAbilityComponent::GetServerTime() const
+{
+	// the synced clock of the local player, the world time on the server
+	return USClockSyncComponent::GetServerTime(this);
+}
+
+bool USAbilityComponent::IsAbilityReady(int32 AbilityIndex, float Tolerance) const
+{
+	if (!CooldownEndTimes.IsValidIndex(AbilityIndex))
+	{
+		return false;
+	}
+
+	return GetServerTime() + Tolerance >= CooldownEndTimes[AbilityIndex];
+}
+
+bool USAbilityComponent::CanActivateAbility(FName AbilityName) const
+{
+	return IsAbilityReady(FindAbilityIndex(AbilityName), 0.0f);
+}
+
+float USAbilityComponent::GetCooldownRemaining(FName AbilityName) const
+{
+	const int32 AbilityIndex = FindAbilityIndex(AbilityName);
+
+	if (!CooldownEndTimes.IsValidIndex(AbilityIndex))
+	{
+		return 0.0f;
+	}
+
+	return FMath::Max(CooldownEndTimes[AbilityIndex] - GetServerTime(), 0.0f);
+}
+
+void USAbilityComponent::CommitAbilityByIndex(int32 AbilityIndex)
+{
+	CooldownEndTimes[AbilityIndex] = GetServerTime() + Abilities[AbilityIndex].Cooldown;
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		// lets simulated proxies play the cosmetic side of the ability
+		LastActivation.AbilityIndex = AbilityIndex;
+		LastActivation.ActivationCount++;
+	}
+
+	OnAbilityActivated.Broadcast(this, Abilities[AbilityIndex].AbilityName);
+}
+
+bool USAbilityComponent::CommitAbility(FName AbilityName)
+{
+	const int32 AbilityIndex = FindAbilityIndex(AbilityName);
+
+	if (!IsAbilityReady(AbilityIndex, GetOwnerRole() == ROLE_Authority ? ServerCooldownTolerance : 0.0f))
+	{
+		return false;
+	}
+
+	CommitAbilityByIndex(AbilityIndex);
+
+	return true;
+}
+
+bool USAbilityComponent::TryActivateAbility(FName AbilityName)
+{
+	const int32 AbilityIndex = FindAbilityIndex(AbilityName);
+
+	if (!IsAbilityReady(AbilityIndex, 0.0f))
+	{
+		return false;
+	}
+
+	// predict locally, the server will correct us through ClientRejectAbility if it disagrees
+	CommitAbilityByIndex(AbilityIndex);
+
+	if (GetOwnerRole() < ROLE_Authority)
+	{
+		ServerActivateAbility(AbilityIndex);
+	}
+
+	return true;
+}
+
+void USAbilityComponent::ServerActivateAbility_Implementation(uint8 AbilityIndex)
+{
+	static const FName RpcName(TEXT("ServerActivateAbility"));
+
+	if (!ActivateRateLimit.TryConsume(GetWorld()->GetTimeSeconds()))
+	{
+		FSRpcRateLimitStats::RecordDropped(GetOwner(), RpcName, TEXT("over ability budget"));
+
+		// the client already predicted the cooldown, put it back to what the server has
+		ClientRejectAbility(AbilityIndex, CooldownEndTimes[AbilityIndex]);
+		return;
+	}
+
+	FSRpcRateLimitStats::RecordAccepted(RpcName);
+
+	if (!IsAbilityReady(AbilityIndex, ServerCooldownTolerance))
+	{
+		ClientRejectAbility(AbilityIndex, CooldownEndTimes[AbilityIndex]);
+		return;
+	}
+
+	CommitAbilityByIndex(AbilityIndex);
+}
+
+bool USAbilityComponent::ServerActivateAbility_Validate(uint8 AbilityIndex)
+{
+	// an index we never handed out can only come from a modified client
+	return Abilities.IsValidIndex(AbilityIndex);
+}
+
+void USAbilityComponent::ClientRejectAbility_Implementation(uint8 AbilityIndex, float ServerCooldownEndTime)
+{
+	if (CooldownEndTimes.IsValidIndex(AbilityIndex))
+	{
+		CooldownEndTimes[AbilityIndex] = ServerCooldownEndTime;
+	}
+}
+
+void USAbilityComponent::OnRep_LastActivation()
+{
+	if (Abilities.IsValidIndex(LastActivation.AbilityIndex))
+	{
+		OnAbilityActivated.Broadcast(this, Abilities[LastActivation.AbilityIndex].AbilityName);
+	}
+}
+
+void USAbilityComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(USAbilityComponent, CooldownEndTimes, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(USAbilityComponent, LastActivation, COND_SkipOwner);
+}
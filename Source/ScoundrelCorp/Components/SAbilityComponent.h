@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ScoundrelCorp/Public/SRpcRateLimiter.h"
+#include "SAbilityComponent.generated.h"
+
+// Design time description of a single ability slot.
+USTRUCT(BlueprintType)
+struct FSAbilityDefinition
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ability")
+	FName AbilityName;
+
+	/* Cooldown in seconds, measured in server time */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ability", meta = (ClampMin = 0.0f))
+	float Cooldown;
+
+	FSAbilityDefinition()
+		: AbilityName(NAME_None)
+		, Cooldown(0.0f)
+	{}
+
+	FSAbilityDefinition(FName InAbilityName, float InCooldown)
+		: AbilityName(InAbilityName)
+		, Cooldown(InCooldown)
+	{}
+};
+
+// Replicated to simulated proxies so they can play the cosmetic side of an ability.
+USTRUCT()
+struct FSAbilityActivation
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	uint8 AbilityIndex;
+
+	// bumped on every activation so the same ability used twice still triggers the OnRep
+	UPROPERTY()
+	uint8 ActivationCount;
+
+	FSAbilityActivation()
+		: AbilityIndex(0)
+		, ActivationCount(0)
+	{}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAbilityActivatedSignature, USAbilityComponent*, AbilityComp, FName, AbilityName);
+
+/**
+ * Holds every ability of a character and their cooldowns.
+ * Cooldowns are stored as end times in server time, so nothing ticks and no timers are needed;
+ * the owning client predicts activations and the server validates them against its own clock.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SCOUNDRELCORP_API USAbilityComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USAbilityComponent();
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ability")
+	TArray<FSAbilityDefinition> Abilities;
+
+	/* Server time at which each ability in Abilities comes off cooldown. Only the owner needs these. */
+	UPROPERTY(Transient, Replicated)
+	TArray<float> CooldownEndTimes;
+
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_LastActivation)
+	FSAbilityActivation LastActivation;
+
+	UFUNCTION()
+	void OnRep_LastActivation();
+
+	/* How early (in seconds) the server accepts a predicted activation, covers clock error between client and server */
+	UPROPERTY(EditDefaultsOnly, Category = "Ability", meta = (ClampMin = 0.0f))
+	float ServerCooldownTolerance;
+
+	int32 FindAbilityIndex(FName AbilityName) const;
+
+	bool IsAbilityReady(int32 AbilityIndex, float Tolerance) const;
+
+	void CommitAbilityByIndex(int32 AbilityIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerActivateAbility(uint8 AbilityIndex);
+
+	// server side budget for ServerActivateAbility, derived from the shortest cooldown
+	FSRpcTokenBucket ActivateRateLimit;
+
+	UFUNCTION(Client, Reliable)
+	void ClientRejectAbility(uint8 AbilityIndex, float ServerCooldownEndTime);
+
+public:
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnAbilityActivatedSignature OnAbilityActivated;
+
+	/* Predicts the activation locally and asks the server to confirm it. Returns false if the ability is still cooling down. */
+	UFUNCTION(BlueprintCallable, Category = "Ability")
+	bool TryActivateAbility(FName AbilityName);
+
+	/* Starts the cooldown and fires OnAbilityActivated without sending an RPC. Used by systems that carry activation themselves (e.g. movement). */
+	bool CommitAbility(FName AbilityName);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Ability")
+	bool CanActivateAbility(FName AbilityName) const;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Ability")
+	float GetCooldownRemaining(FName AbilityName) const;
+
+	/* Server time used for every cooldown stamp */
+	float GetServerTime() const;
+};
@@ -0,0 +1,216 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SCharacterMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "ScoundrelCorp/Components/SAbilityComponent.h"
+
+// FLAG_WantsToCrouch and FLAG_JumpPressed are already used by the engine
+#define FLAG_WANTSTOSPRINT		FSavedMove_Character::FLAG_Custom_0
+#define FLAG_WANTSTODODGE		FSavedMove_Character::FLAG_Custom_1
+
+USCharacterMovementComponent::USCharacterMovementComponent()
+{
+	SprintSpeedMultiplier = 1.5f;
+	DodgeSpeed = 1500.0f;
+	DodgeAbilityName = "DodgeRoll";
+
+	bWantsToSprint = false;
+	bWantsToDodge = false;
+	bDodgedThisMove = false;
+}
+
+void USCharacterMovementComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	AbilityComp = GetOwner() ? GetOwner()->FindComponentByClass<USAbilityComponent>() : nullptr;
+}
+
+float USCharacterMovementComponent::GetMaxSpeed() const
+{
+	const float MaxSpeed = Super::GetMaxSpeed();
+
+	if (IsSprinting())
+	{
+		return MaxSpeed * SprintSpeedMultiplier;
+	}
+
+	return MaxSpeed;
+}
+
+bool USCharacterMovementComponent::IsSprinting() const
+{
+	return bWantsToSprint && MovementMode == MOVE_Walking && !IsCrouching();
+}
+
+void USCharacterMovementComponent::SetSprinting(bool bNewSprinting)
+{
+	bWantsToSprint = bNewSprinting;
+}
+
+void USCharacterMovementComponent::RequestDodge()
+{
+	// consumed by the next move, which also saves it for the server and for replays
+	if (CanDodge())
+	{
+		bWantsToDodge = true;
+	}
+}
+
+void USCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	bWantsToSprint = (Flags & FLAG_WANTSTOSPRINT) != 0;
+	bWantsToDodge = (Flags & FLAG_WANTSTODODGE) != 0;
+}
+
+void USCharacterMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	bDodgedThisMove = false;
+
+	if (bWantsToDodge)
+	{
+		bWantsToDodge = false;
+
+		if (CharacterOwner && CharacterOwner->bClientUpdating)
+		{
+			// replaying a saved move after a correction, PrepMoveFor only asks for the dodges that really happened
+			// and the cooldown was already committed when the move was first made
+			bDodgedThisMove = IsMovingOnGround();
+		}
+		else
+		{
+			bDodgedThisMove = IsMovingOnGround() && (AbilityComp == nullptr || AbilityComp->CommitAbility(DodgeAbilityName));
+		}
+
+		if (bDodgedThisMove)
+		{
+			PerformDodge();
+		}
+	}
+}
+
+bool USCharacterMovementComponent::CanDodge() const
+{
+	if (!IsMovingOnGround())
+	{
+		return false;
+	}
+
+	return AbilityComp == nullptr || AbilityComp->CanActivateAbility(DodgeAbilityName);
+}
+
+void USCharacterMovementComponent::PerformDodge()
+{
+	// roll toward the input direction, or forward if there isn't any
+	FVector DodgeDirection = Acceleration.GetSafeNormal2D();
+	if (DodgeDirection.IsNearlyZero() && CharacterOwner)
+	{
+		DodgeDirection = CharacterOwner->GetActorForwardVector().GetSafeNormal2D();
+	}
+
+	Velocity.X = DodgeDirection.X * DodgeSpeed;
+	Velocity.Y = DodgeDirection.Y * DodgeSpeed;
+}
+
+FNetworkPredictionData_Client* USCharacterMovementComponent::GetPredictionData_Client() const
+{
+	check(PawnOwner != nullptr);
+
+	if (ClientPredictionData == nullptr)
+	{
+		USCharacterMovementComponent* MutableThis = const_cast<USCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_SCharacter(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void FSavedMove_SCharacter::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToSprint = false;
+	bSavedWantsToDodge = false;
+	bSavedDidDodge = false;
+}
+
+uint8 FSavedMove_SCharacter::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToSprint)
+	{
+		Result |= FLAG_WANTSTOSPRINT;
+	}
+
+	if (bSavedWantsToDodge)
+	{
+		Result |= FLAG_WANTSTODODGE;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_SCharacter::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_SCharacter* NewSMove = static_cast<const FSavedMove_SCharacter*>(NewMove.Get());
+
+	// a dodge has to reach the server as its own move, and sprint changes the max speed of the move
+	if (bSavedWantsToDodge || NewSMove->bSavedWantsToDodge || bSavedWantsToSprint != NewSMove->bSavedWantsToSprint)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_SCharacter::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	USCharacterMovementComponent* MoveComp = Cast<USCharacterMovementComponent>(C->GetCharacterMovement());
+	if (MoveComp)
+	{
+		bSavedWantsToSprint = MoveComp->bWantsToSprint;
+		bSavedWantsToDodge = MoveComp->bWantsToDodge;
+	}
+}
+
+void FSavedMove_SCharacter::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	USCharacterMovementComponent* MoveComp = Cast<USCharacterMovementComponent>(C->GetCharacterMovement());
+	if (MoveComp)
+	{
+		MoveComp->bWantsToSprint = bSavedWantsToSprint;
+		// a dodge the cooldown turned down when the move was made must not appear in the replay
+		MoveComp->bWantsToDodge = bSavedDidDodge;
+	}
+}
+
+void FSavedMove_SCharacter::PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode)
+{
+	Super::PostUpdate(C, PostUpdateMode);
+
+	USCharacterMovementComponent* MoveComp = Cast<USCharacterMovementComponent>(C->GetCharacterMovement());
+	if (MoveComp && PostUpdateMode == PostUpdate_Record)
+	{
+		bSavedDidDodge = MoveComp->bDodgedThisMove;
+	}
+}
+
+FNetworkPredictionData_Client_SCharacter::FNetworkPredictionData_Client_SCharacter(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_SCharacter::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_SCharacter());
+}
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "SCharacterMovementComponent.generated.h"
+
+class USAbilityComponent;
+
+/**
+ * Character movement with sprint and dodge roll carried in the saved move compressed flags,
+ * so prediction, replay and server correction handle them like jump and crouch (crouch already uses FLAG_WantsToCrouch).
+ */
+UCLASS()
+class SCOUNDRELCORP_API USCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_SCharacter;
+
+public:
+	USCharacterMovementComponent();
+
+	virtual float GetMaxSpeed() const override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	UFUNCTION(BlueprintCallable, Category = "Character Movement: Sprint")
+	void SetSprinting(bool bNewSprinting);
+
+	UFUNCTION(BlueprintCallable, Category = "Character Movement: Dodge")
+	void RequestDodge();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Character Movement: Sprint")
+	bool IsSprinting() const;
+
+	FName GetDodgeAbilityName() const { return DodgeAbilityName; }
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+
+	bool CanDodge() const;
+
+	void PerformDodge();
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Sprint", meta = (ClampMin = 1.0f))
+	float SprintSpeedMultiplier;
+
+	/* Horizontal speed the dodge roll kicks the character to, ground friction brings it back down */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Dodge", meta = (ClampMin = 0.0f))
+	float DodgeSpeed;
+
+	/* Ability in the owner's ability comp that gates the dodge cooldown */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Character Movement: Dodge")
+	FName DodgeAbilityName;
+
+	UPROPERTY()
+	USAbilityComponent* AbilityComp;
+
+	uint8 bWantsToSprint : 1;
+
+	uint8 bWantsToDodge : 1;
+
+	/* Whether the move just performed actually rolled, saved so replays only redo accepted dodges */
+	uint8 bDodgedThisMove : 1;
+};
+
+class FSavedMove_SCharacter : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+
+	virtual uint8 GetCompressedFlags() const override;
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override;
+
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	virtual void PostUpdate(ACharacter* C, EPostUpdateMode PostUpdateMode) override;
+
+	uint8 bSavedWantsToSprint : 1;
+
+	uint8 bSavedWantsToDodge : 1;
+
+	uint8 bSavedDidDodge : 1;
+};
+
+class FNetworkPredictionData_Client_SCharacter : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_SCharacter(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SClockSyncComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Clock Offset (ms)"), STAT_SCClockOffset, STATGROUP_ScoundrelCorp);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Clock Jitter (ms)"), STAT_SCClockJitter, STATGROUP_ScoundrelCorp);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Clock Best RTT (ms)"), STAT_SCClockBestRTT, STATGROUP_ScoundrelCorp);
+
+float ClockSyncInterval = 2.0f;
+FAutoConsoleVariableRef CVARClockSyncInterval(
+	TEXT("SC.ClockSync.Interval"),
+	ClockSyncInterval,
+	TEXT("Seconds between clock sync requests once the clock has settled"),
+	ECVF_Default);
+
+float ClockSyncSlewRate = 0.01f;
+FAutoConsoleVariableRef CVARClockSyncSlewRate(
+	TEXT("SC.ClockSync.SlewRate"),
+	ClockSyncSlewRate,
+	TEXT("Seconds of clock correction applied per second, larger errors than SnapThreshold jump instead"),
+	ECVF_Default);
+
+float ClockSyncSnapThreshold = 0.25f;
+FAutoConsoleVariableRef CVARClockSyncSnapThreshold(
+	TEXT("SC.ClockSync.SnapThreshold"),
+	ClockSyncSnapThreshold,
+	TEXT("Clock error in seconds past which the clock jumps instead of slewing"),
+	ECVF_Default);
+
+namespace
+{
+	const int32 ClockSampleWindow = 8;
+
+	// the first requests go out quickly so the clock is usable right after joining
+	const int32 ClockBurstRequests = 5;
+	const float ClockBurstInterval = 0.2f;
+}
+
+// Sets default values for this component's properties
+USClockSyncComponent::USClockSyncComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	NextSampleIndex = 0;
+	ClockOffset = 0.0f;
+	TargetClockOffset = 0.0f;
+	BestRoundTripTime = 0.0f;
+	Jitter = 0.0f;
+	bHasSynced = false;
+	TimeUntilNextRequest = 0.0f;
+	NumRequestsSent = 0;
+	SyncStartTime = 0.0f;
+
+	// a burst on join and one every couple of seconds after, anything more is abuse
+	RequestRateLimit.Configure(2.0f, ClockBurstRequests + 1.0f);
+
+	SetIsReplicated(true);
+}
+
+// Called when the game starts
+void USClockSyncComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// only the owning client has a clock to sync, the server is the clock
+	SetComponentTickEnabled(IsSyncingClient());
+}
+
+void USClockSyncComponent::ResetSync()
+{
+	Samples.Reset();
+	NextSampleIndex = 0;
+	ClockOffset = 0.0f;
+	TargetClockOffset = 0.0f;
+	BestRoundTripTime = 0.0f;
+	Jitter = 0.0f;
+	bHasSynced = false;
+	TimeUntilNextRequest = 0.0f;
+	NumRequestsSent = 0;
+	SyncStartTime = GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+
+	SetComponentTickEnabled(IsSyncingClient());
+}
+
+bool USClockSyncComponent::IsSyncingClient() const
+{
+	const APlayerController* PC = Cast<APlayerController>(GetOwner());
+
+	return PC && PC->IsLocalController() && GetOwnerRole() < ROLE_Authority;
+}
+
+void USClockSyncComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	TimeUntilNextRequest -= DeltaTime;
+	if (TimeUntilNextRequest <= 0.0f)
+	{
+		SendTimeRequest();
+		TimeUntilNextRequest = NumRequestsSent < ClockBurstRequests ? ClockBurstInterval : ClockSyncInterval;
+	}
+
+	// slew, never step backwards for small corrections
+	const float Error = TargetClockOffset - ClockOffset;
+	const float MaxCorrection = ClockSyncSlewRate * DeltaTime;
+	ClockOffset += FMath::Clamp(Error, -MaxCorrection, MaxCorrection);
+
+	SET_FLOAT_STAT(STAT_SCClockOffset, ClockOffset * 1000.0f);
+	SET_FLOAT_STAT(STAT_SCClockJitter, Jitter * 1000.0f);
+	SET_FLOAT_STAT(STAT_SCClockBestRTT, BestRoundTripTime * 1000.0f);
+}
+
+float USClockSyncComponent::GetServerTime() const
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr)
+	{
+		return 0.0f;
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		return World->GetTimeSeconds();
+	}
+
+	if (!bHasSynced)
+	{
+		// no sample yet, the replicated game state time is better than nothing
+		const AGameStateBase* GS = World->GetGameState();
+		return GS ? GS->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+	}
+
+	return World->GetTimeSeconds() + ClockOffset;
+}
+
+float USClockSyncComponent::GetServerTime(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr)
+	{
+		return 0.0f;
+	}
+
+	if (World->GetNetMode() < NM_Client)
+	{
+		return World->GetTimeSeconds();
+	}
+
+	APlayerController* PC = World->GetFirstPlayerController();
+	USClockSyncComponent* ClockSync = PC ? PC->FindComponentByClass<USClockSyncComponent>() : nullptr;
+	if (ClockSync)
+	{
+		return ClockSync->GetServerTime();
+	}
+
+	const AGameStateBase* GS = World->GetGameState();
+	return GS ? GS->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void USClockSyncComponent::SendTimeRequest()
+{
+	NumRequestsSent++;
+
+	ServerRequestTime(GetWorld()->GetTimeSeconds());
+}
+
+void USClockSyncComponent::ServerRequestTime_Implementation(float ClientSendTime)
+{
+	static const FName RpcName(TEXT("ServerRequestTime"));
+
+	if (!RequestRateLimit.TryConsume(GetWorld()->GetTimeSeconds()))
+	{
+		FSRpcRateLimitStats::RecordDropped(GetOwner(), RpcName, TEXT("over clock sync budget"));
+		return;
+	}
+
+	FSRpcRateLimitStats::RecordAccepted(RpcName);
+
+	ClientReportTime(ClientSendTime, GetWorld()->GetTimeSeconds());
+}
+
+void USClockSyncComponent::ClientReportTime_Implementation(float ClientSendTime, float ServerTime)
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float RoundTripTime = Now - ClientSendTime;
+
+	// sent from the previous map, both clocks have restarted since
+	if (RoundTripTime < 0.0f || ClientSendTime < SyncStartTime)
+	{
+		return;
+	}
+
+	// assume the reply took half the round trip to get here
+	AddSample(RoundTripTime, ServerTime + RoundTripTime * 0.5f - Now);
+}
+
+void USClockSyncComponent::AddSample(float RoundTripTime, float Offset)
+{
+	if (Samples.Num() < ClockSampleWindow)
+	{
+		Samples.Add({ RoundTripTime, Offset });
+	}
+	else
+	{
+		Samples[NextSampleIndex] = { RoundTripTime, Offset };
+	}
+	NextSampleIndex = (NextSampleIndex + 1) % ClockSampleWindow;
+
+	// the fastest round trip spent the least time queued, so its half RTT guess is the most accurate
+	const FClockSample* Best = &Samples[0];
+	float MeanRoundTripTime = 0.0f;
+	for (const FClockSample& Sample : Samples)
+	{
+		MeanRoundTripTime += Sample.RoundTripTime;
+		if (Sample.RoundTripTime < Best->RoundTripTime)
+		{
+			Best = &Sample;
+		}
+	}
+	MeanRoundTripTime /= Samples.Num();
+
+	float Variance = 0.0f;
+	for (const FClockSample& Sample : Samples)
+	{
+		Variance += FMath::Square(Sample.RoundTripTime - MeanRoundTripTime);
+	}
+
+	Jitter = FMath::Sqrt(Variance / Samples.Num());
+	BestRoundTripTime = Best->RoundTripTime;
+	TargetClockOffset = Best->Offset;
+
+	if (!bHasSynced || FMath::Abs(TargetClockOffset - ClockOffset) > ClockSyncSnapThreshold)
+	{
+		ClockOffset = TargetClockOffset;
+		bHasSynced = true;
+	}
+}
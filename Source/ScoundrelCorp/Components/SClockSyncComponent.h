@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ScoundrelCorp/Public/SRpcRateLimiter.h"
+#include "SClockSyncComponent.generated.h"
+
+/**
+ * Keeps an estimate of the server's clock on the owning client.
+ * Timestamps are exchanged with the server every few seconds, the offset comes from the lowest round trip sample of a small window
+ * (the one least delayed by queueing) and the clock is slewed towards it instead of jumping, so server time never runs backwards.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SCOUNDRELCORP_API USClockSyncComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USClockSyncComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/* The server's world time as seen from here, exact on the server */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ClockSync")
+	float GetServerTime() const;
+
+	/* Server time from the local player's clock sync, for code that only has a world context */
+	static float GetServerTime(const UObject* WorldContextObject);
+
+	/* Estimated server minus local time, in seconds */
+	float GetClockOffset() const { return ClockOffset; }
+
+	float GetRoundTripTime() const { return BestRoundTripTime; }
+
+	float GetJitter() const { return Jitter; }
+
+	bool HasSynced() const { return bHasSynced; }
+
+	/* Throws the samples away and starts over with a burst, for when the world clocks restart (seamless travel) */
+	void ResetSync();
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	bool IsSyncingClient() const;
+
+	void SendTimeRequest();
+
+	UFUNCTION(Server, Unreliable)
+	void ServerRequestTime(float ClientSendTime);
+
+	UFUNCTION(Client, Unreliable)
+	void ClientReportTime(float ClientSendTime, float ServerTime);
+
+	void AddSample(float RoundTripTime, float Offset);
+
+	struct FClockSample
+	{
+		float RoundTripTime;
+
+		float Offset;
+	};
+
+	TArray<FClockSample> Samples;
+
+	int32 NextSampleIndex;
+
+	/* Offset currently applied, slewed towards TargetClockOffset */
+	float ClockOffset;
+
+	float TargetClockOffset;
+
+	float BestRoundTripTime;
+
+	float Jitter;
+
+	bool bHasSynced;
+
+	float TimeUntilNextRequest;
+
+	int32 NumRequestsSent;
+
+	/* Local time of the last reset, replies to requests sent before it are ignored */
+	float SyncStartTime;
+
+	FSRpcTokenBucket RequestRateLimit;
+};
@@ -3,8 +3,10 @@
 
 #include "SHealthComponent.h"
 #include "SGameMode.h"
+#include "SGameState.h"
 #include <Runtime/Engine/Classes/GameFramework/Actor.h>
 #include "Net/UnrealNetwork.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
 
 // Sets default values for this component's properties
 USHealthComponent::USHealthComponent()
@@ -55,22 +57,46 @@ void USHealthComponent::HandleTakeAnyDamage(AActor* DamagedActor, float Damage,
 		return;
 	}
 
-	Health = FMath::Clamp(Health - Damage, 0.0f, DefaultHealth);
+	ApplyHealthChange(-Damage, DamageType, InstigatedBy, DamageCauser);
+}
 
-	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s"), *FString::SanitizeFloat(Health));
+void USHealthComponent::ApplyHealthChange(float HealthChange, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	if (HealthChange == 0.0f || bIsDead)
+	{
+		return;
+	}
 
-	OnHealthChanged.Broadcast(this, Health, Damage, DamageType, InstigatedBy, DamageCauser);
+	const float OldHealth = Health;
+
+	Health = FMath::Clamp(Health + HealthChange, 0.0f, DefaultHealth);
+
+	// status effects land here several times a second per actor, so this stays out of the default log
+	UE_LOG(LogScoundrelCorp, Verbose, TEXT("Health Changed: %s (%s) on %s"), *FString::SanitizeFloat(Health), *FString::SanitizeFloat(HealthChange), *GetNameSafe(GetOwner()));
+
+	if (Health < OldHealth)
+	{
+		ASGameState* GS = GetWorld()->GetGameState<ASGameState>();
+		if (GS)
+		{
+			GS->RecordDamage(InstigatedBy, GetOwner(), OldHealth - Health);
+		}
+	}
 
 	bIsDead = Health <= 0.0f;
 
 	if (bIsDead)
-	{		
+	{
+		// before OnHealthChanged, the owner detaches from its controller (and player state) when it dies
 		ASGameMode* GM = Cast<ASGameMode>(GetWorld()->GetAuthGameMode());
 		if (GM)
 		{
 			GM->OnActorKilled.Broadcast(GetOwner(), DamageCauser, InstigatedBy);
 		}
 	}
+
+	// positive delta means damage, like OnTakeAnyDamage
+	OnHealthChanged.Broadcast(this, Health, -HealthChange, DamageType, InstigatedBy, DamageCauser);
 }
 
 void USHealthComponent::Heal(float HealAmount)
@@ -79,12 +105,7 @@ void USHealthComponent::Heal(float HealAmount)
 		return;
 	}
 
-	Health = FMath::Clamp(Health + HealAmount, 0.0f, DefaultHealth);
-
-	UE_LOG(LogTemp, Log, TEXT("Health Changed: %s (+%s)"), *FString::SanitizeFloat(Health), *FString::SanitizeFloat(HealAmount));
-
-	OnHealthChanged.Broadcast(this, Health, -HealAmount, nullptr, nullptr, nullptr);
-
+	ApplyHealthChange(HealAmount, nullptr, nullptr, nullptr);
 }
 
 float USHealthComponent::GetHealth() const
@@ -43,8 +43,15 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "HealthComponent")
 		void Heal(float HealAmount);
 
+	/* Server only. Positive heals, negative damages; broadcasts OnHealthChanged once and handles death. */
+	void ApplyHealthChange(float HealthChange, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
 	float GetHealth() const;
 
+	float GetDefaultHealth() const { return DefaultHealth; }
+
+	bool IsDead() const { return bIsDead; }
+
 	UPROPERTY(EditDefaultsOnly, Replicated, BlueprintReadOnly, Category = "HealthComponent")
 		uint8 TeamNum;
 
@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SInventoryComponent.h"
+#include "ScoundrelCorp/Public/SWeapon.h"
+#include "ScoundrelCorp/Public/SWeaponDefinition.h"
+#include "Net/UnrealNetwork.h"
+
+// Sets default values for this component's properties
+USInventoryComponent::USInventoryComponent()
+{
+	ActiveIndex = INDEX_NONE;
+
+	// a few quick scrolls are fine, a client spamming switches isn't
+	EquipRateLimit.Configure(10.0f, 5.0f);
+
+	SetIsReplicated(true);
+}
+
+void USInventoryComponent::InitializeInventory(ASWeapon* InWeaponActor)
+{
+	if (GetOwnerRole() < ROLE_Authority || InWeaponActor == nullptr)
+	{
+		return;
+	}
+
+	WeaponActor = InWeaponActor;
+	Entries.Reset();
+
+	if (StartingWeapons.Num() == 0)
+	{
+		// the starting weapon actor already set itself up from its own definition
+		FSInventoryEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.Definition = WeaponActor->GetWeaponDefinition();
+		Entry.CurrentAmmo = WeaponActor->GetCurrentAmmo();
+		Entry.CurrentAmmoInMag = WeaponActor->GetCurrentAmmoInMag();
+
+		ActiveIndex = 0;
+		OnActiveWeaponChanged.Broadcast(this, ActiveIndex);
+		return;
+	}
+
+	for (USWeaponDefinition* Definition : StartingWeapons)
+	{
+		if (Definition == nullptr)
+		{
+			continue;
+		}
+
+		FSInventoryEntry& Entry = Entries.AddDefaulted_GetRef();
+		Entry.Definition = Definition;
+		Entry.CurrentAmmoInMag = Definition->InitialMags > 0 ? Definition->AmmoPerMag : 0;
+		Entry.CurrentAmmo = Definition->AmmoPerMag * Definition->InitialMags;
+	}
+
+	ActiveIndex = INDEX_NONE;
+	EquipWeapon(0);
+}
+
+void USInventoryComponent::EquipWeapon(int32 NewIndex)
+{
+	if (GetOwnerRole() < ROLE_Authority)
+	{
+		ServerEquipWeapon(NewIndex);
+		return;
+	}
+
+	if (!Entries.IsValidIndex(NewIndex) || NewIndex == ActiveIndex || WeaponActor == nullptr)
+	{
+		return;
+	}
+
+	// stash the ammo of the weapon we are putting away
+	if (Entries.IsValidIndex(ActiveIndex))
+	{
+		Entries[ActiveIndex].CurrentAmmo = WeaponActor->GetCurrentAmmo();
+		Entries[ActiveIndex].CurrentAmmoInMag = WeaponActor->GetCurrentAmmoInMag();
+	}
+
+	const FSInventoryEntry& NewEntry = Entries[NewIndex];
+	WeaponActor->EquipDefinition(NewEntry.Definition, NewEntry.CurrentAmmo, NewEntry.CurrentAmmoInMag);
+
+	ActiveIndex = NewIndex;
+	OnActiveWeaponChanged.Broadcast(this, ActiveIndex);
+}
+
+void USInventoryComponent::EquipNextWeapon()
+{
+	const int32 NumWeapons = Entries.Num();
+	if (NumWeapons > 1)
+	{
+		EquipWeapon((ActiveIndex + 1) % NumWeapons);
+	}
+}
+
+void USInventoryComponent::EquipPreviousWeapon()
+{
+	const int32 NumWeapons = Entries.Num();
+	if (NumWeapons > 1)
+	{
+		EquipWeapon((ActiveIndex + NumWeapons - 1) % NumWeapons);
+	}
+}
+
+void USInventoryComponent::ServerEquipWeapon_Implementation(int32 NewIndex)
+{
+	static const FName RpcName(TEXT("ServerEquipWeapon"));
+
+	if (!EquipRateLimit.TryConsume(GetWorld()->GetTimeSeconds()))
+	{
+		FSRpcRateLimitStats::RecordDropped(GetOwner(), RpcName, TEXT("over equip budget"));
+		return;
+	}
+
+	FSRpcRateLimitStats::RecordAccepted(RpcName);
+
+	EquipWeapon(NewIndex);
+}
+
+bool USInventoryComponent::ServerEquipWeapon_Validate(int32 NewIndex)
+{
+	return true;
+}
+
+void USInventoryComponent::OnRep_ActiveIndex()
+{
+	OnActiveWeaponChanged.Broadcast(this, ActiveIndex);
+}
+
+void USInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(USInventoryComponent, Entries, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(USInventoryComponent, ActiveIndex, COND_OwnerOnly);
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "ScoundrelCorp/Public/SRpcRateLimiter.h"
+#include "SInventoryComponent.generated.h"
+
+class ASWeapon;
+class USWeaponDefinition;
+
+// A weapon the character is carrying but may not be holding. Just a definition and its ammo, no actor.
+USTRUCT(BlueprintType)
+struct FSInventoryEntry
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	USWeaponDefinition* Definition;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 CurrentAmmo;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 CurrentAmmoInMag;
+
+	FSInventoryEntry()
+		: Definition(nullptr)
+		, CurrentAmmo(0)
+		, CurrentAmmoInMag(0)
+	{}
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnActiveWeaponChangedSignature, USInventoryComponent*, InventoryComp, int32, ActiveIndex);
+
+/**
+ * Weapon inventory of a character.
+ * Only the active weapon exists as a (replicated) actor; switching re-equips that same actor with another definition,
+ * so carrying more weapons costs an array entry instead of another actor channel.
+ */
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class SCOUNDRELCORP_API USInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	USInventoryComponent();
+
+protected:
+
+	/* Definitions given to the character on spawn, the first one is equipped. Empty means just the starting weapon actor's own definition. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Inventory")
+	TArray<USWeaponDefinition*> StartingWeapons;
+
+	/* Only changes when a weapon is picked up or stashed, and only the owner needs it */
+	UPROPERTY(Transient, Replicated)
+	TArray<FSInventoryEntry> Entries;
+
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_ActiveIndex)
+	int32 ActiveIndex;
+
+	UFUNCTION()
+	void OnRep_ActiveIndex();
+
+	UPROPERTY(Transient)
+	ASWeapon* WeaponActor;
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerEquipWeapon(int32 NewIndex);
+
+	FSRpcTokenBucket EquipRateLimit;
+
+public:
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnActiveWeaponChangedSignature OnActiveWeaponChanged;
+
+	/* Server only. Fills the inventory and equips the first weapon on the given actor. */
+	void InitializeInventory(ASWeapon* InWeaponActor);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void EquipWeapon(int32 NewIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void EquipNextWeapon();
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void EquipPreviousWeapon();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Inventory")
+	int32 GetActiveIndex() const { return ActiveIndex; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Inventory")
+	int32 GetNumWeapons() const { return Entries.Num(); }
+};
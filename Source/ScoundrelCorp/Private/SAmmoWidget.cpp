@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SAmmoWidget.h"
+#include "Components/TextBlock.h"
+#include "SWeapon.h"
+
+USAmmoWidget::USAmmoWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	DisplayedAmmoInMag = -1;
+	DisplayedReserveAmmo = -1;
+}
+
+void USAmmoWidget::OnObservedWeaponChanged(ASWeapon* OldWeapon, ASWeapon* NewWeapon)
+{
+	if (OldWeapon)
+	{
+		OldWeapon->OnAmmoChanged.RemoveDynamic(this, &USAmmoWidget::HandleAmmoChanged);
+		OldWeapon->OnReloadStateChanged.RemoveDynamic(this, &USAmmoWidget::HandleReloadStateChanged);
+	}
+
+	if (NewWeapon)
+	{
+		NewWeapon->OnAmmoChanged.AddDynamic(this, &USAmmoWidget::HandleAmmoChanged);
+		NewWeapon->OnReloadStateChanged.AddDynamic(this, &USAmmoWidget::HandleReloadStateChanged);
+
+		UpdateAmmo(NewWeapon->GetCurrentAmmoInMag(), NewWeapon->GetCurrentAmmo());
+		UpdateReloading(NewWeapon->IsReloading());
+	}
+	else
+	{
+		UpdateAmmo(0, 0);
+		UpdateReloading(false);
+	}
+}
+
+void USAmmoWidget::HandleAmmoChanged(ASWeapon* Weapon, int32 AmmoInMag, int32 TotalAmmo)
+{
+	UpdateAmmo(AmmoInMag, TotalAmmo);
+}
+
+void USAmmoWidget::HandleReloadStateChanged(ASWeapon* Weapon, bool bReloading)
+{
+	UpdateReloading(bReloading);
+}
+
+void USAmmoWidget::UpdateAmmo(int32 AmmoInMag, int32 TotalAmmo)
+{
+	// total ammo counts the magazine too
+	const int32 ReserveAmmo = FMath::Max(TotalAmmo - AmmoInMag, 0);
+
+	if (AmmoInMag != DisplayedAmmoInMag)
+	{
+		DisplayedAmmoInMag = AmmoInMag;
+		AmmoInMagText->SetText(FText::AsNumber(AmmoInMag));
+	}
+
+	if (ReserveAmmo != DisplayedReserveAmmo)
+	{
+		DisplayedReserveAmmo = ReserveAmmo;
+		ReserveAmmoText->SetText(FText::AsNumber(ReserveAmmo));
+	}
+}
+
+void USAmmoWidget::UpdateReloading(bool bReloading)
+{
+	if (ReloadingIndicator)
+	{
+		// SetVisibility already skips the invalidation when nothing changes
+		ReloadingIndicator->SetVisibility(bReloading ? ESlateVisibility::HitTestInvisible : ESlateVisibility::Collapsed);
+	}
+}
@@ -12,13 +12,25 @@
 #include "Components/CapsuleComponent.h"
 #include "ScoundrelCorp/ScoundrelCorp.h"
 #include "ScoundrelCorp/Components/SHealthComponent.h"
+#include "ScoundrelCorp/Components/SAbilityComponent.h"
+#include "ScoundrelCorp/Components/SInventoryComponent.h"
+#include "ScoundrelCorp/Components/SCharacterMovementComponent.h"
+#include "SServerAnimationSubsystem.h"
+#include "SSignificanceSubsystem.h"
+#include "STargetingSubsystem.h"
+#include "SCorpseSubsystem.h"
+#include "SKillcamSubsystem.h"
+#include "GameFramework/CharacterMovementComponent.h"
 #include "Net/UnrealNetwork.h"
 
 // Sets default values
-ASCharacter::ASCharacter()
+ASCharacter::ASCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<USCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
- 	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// only ticks while the zoom is interpolating, see HandleZoom
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	bBlueprintTicks = false;
 
 	SpringArmComp = CreateDefaultSubobject<USpringArmComponent>(TEXT("SpringArmComp"));
 	SpringArmComp->bUsePawnControlRotation = true;
@@ -30,10 +42,17 @@ ASCharacter::ASCharacter()
 
 	HealthComp = CreateDefaultSubobject<USHealthComponent>(TEXT("HealthComp"));
 
+	AbilityComp = CreateDefaultSubobject<USAbilityComponent>(TEXT("AbilityComp"));
+	PrimaryAbilityName = "Snap";
+
+	InventoryComp = CreateDefaultSubobject<USInventoryComponent>(TEXT("InventoryComp"));
+
 	CameraComp = CreateDefaultSubobject<UCameraComponent>(TEXT("CameraComp"));
 	CameraComp->SetupAttachment(SpringArmComp);
 
 	WeaponAttachSocketName = "WeaponSocket";
+
+	ServerCorpseLifeSpan = 1.0f;
 }
 
 // Called when the game starts or when spawned
@@ -43,8 +62,16 @@ void ASCharacter::BeginPlay()
 
 	DefaultFOV = CameraComp->FieldOfView;
 
-	lastAbilityTime = 0.0f;
-	
+	// only zooming needs our native tick, but a Blueprint child with Event Tick expects to tick every frame
+	bBlueprintTicks = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(ASCharacter, ReceiveTick));
+	if (bBlueprintTicks)
+	{
+		SetActorTickEnabled(true);
+	}
+
+	AbilityComp->OnAbilityActivated.AddDynamic(this, &ASCharacter::OnAbilityActivated);
+	InventoryComp->OnActiveWeaponChanged.AddDynamic(this, &ASCharacter::OnActiveWeaponChanged);
+
 	if (GetLocalRole() == ROLE_Authority) {
 		//spawn a default weapon
 		FActorSpawnParameters SpawnParams;
@@ -54,12 +81,77 @@ void ASCharacter::BeginPlay()
 		if (CurrentWeapon) {
 			CurrentWeapon->SetOwner(this);
 			CurrentWeapon->AttachToComponent(GetMesh(), FAttachmentTransformRules::SnapToTargetNotIncludingScale, WeaponAttachSocketName);
+
+			OnCurrentWeaponChanged.Broadcast(this, CurrentWeapon);
 		}
 
+		// the starting weapon actor is the one the inventory swaps definitions on, entries reach the owner through replication
+		InventoryComp->InitializeInventory(CurrentWeapon);
+
 		HealthComp->OnHealthChanged.AddDynamic(this, &ASCharacter::OnHealthChanged);
+
+		GetWorld()->GetSubsystem<USTargetingSubsystem>()->RegisterCharacter(this);
+	}
+
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		// the server only needs our bones to resolve hits
+		GetWorld()->GetSubsystem<USServerAnimationSubsystem>()->RegisterCharacterMesh(GetMesh());
+	}
+	else
+	{
+		GetWorld()->GetSubsystem<USSignificanceSubsystem>()->RegisterCharacter(this);
+		GetWorld()->GetSubsystem<USKillcamSubsystem>()->RegisterCharacter(this);
 	}
 }
 
+void ASCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// the weapon goes with us, a torn off corpse is authority on clients too and takes its torn off weapon along
+	if (GetLocalRole() == ROLE_Authority && CurrentWeapon)
+	{
+		CurrentWeapon->Destroy();
+	}
+
+	if (USServerAnimationSubsystem* ServerAnim = GetWorld()->GetSubsystem<USServerAnimationSubsystem>())
+	{
+		ServerAnim->UnregisterCharacterMesh(GetMesh());
+	}
+
+	if (USSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USSignificanceSubsystem>())
+	{
+		Significance->UnregisterCharacter(this);
+	}
+
+	if (USTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<USTargetingSubsystem>())
+	{
+		Targeting->UnregisterCharacter(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASCharacter::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
+
+	// bots get their targets picked by the targeting subsystem
+	if (NewController && !NewController->IsPlayerController())
+	{
+		GetWorld()->GetSubsystem<USTargetingSubsystem>()->RegisterSeeker(this);
+	}
+}
+
+void ASCharacter::UnPossessed()
+{
+	if (USTargetingSubsystem* Targeting = GetWorld()->GetSubsystem<USTargetingSubsystem>())
+	{
+		Targeting->UnregisterSeeker(this);
+	}
+
+	Super::UnPossessed();
+}
+
 void ASCharacter::MoveForward(float value)
 {
 	AddMovementInput(GetActorForwardVector() * value);
@@ -80,21 +172,105 @@ void ASCharacter::EndCrouch()
 	UnCrouch();
 }
 
+void ASCharacter::BeginSprint()
+{
+	GetSCharacterMovement()->SetSprinting(true);
+}
+
+void ASCharacter::EndSprint()
+{
+	GetSCharacterMovement()->SetSprinting(false);
+}
+
+void ASCharacter::Dodge()
+{
+	// goes through the saved moves instead of an RPC, the movement comp commits the DodgeRoll cooldown
+	GetSCharacterMovement()->RequestDodge();
+}
+
+void ASCharacter::NextWeapon()
+{
+	InventoryComp->EquipNextWeapon();
+}
+
+void ASCharacter::PreviousWeapon()
+{
+	InventoryComp->EquipPreviousWeapon();
+}
+
+void ASCharacter::OnRep_CurrentWeapon()
+{
+	// a zoom started before the weapon arrived can finish now
+	if (bWantsToZoom)
+	{
+		SetActorTickEnabled(true);
+	}
+
+	OnCurrentWeaponChanged.Broadcast(this, CurrentWeapon);
+}
+
+void ASCharacter::OnActiveWeaponChanged(USInventoryComponent* OwningInventoryComp, int32 ActiveIndex)
+{
+	// the new weapon may zoom to a different FOV
+	if (bWantsToZoom)
+	{
+		SetActorTickEnabled(true);
+	}
+}
+
+USCharacterMovementComponent* ASCharacter::GetSCharacterMovement() const
+{
+	return Cast<USCharacterMovementComponent>(GetCharacterMovement());
+}
+
 void ASCharacter::HandleZoom(float DeltaTime)
 {
 	if(CurrentWeapon == nullptr)
+	{
+		// nothing to zoom with, OnRep_CurrentWeapon starts us again when it arrives
+		StopZoomTick();
 		return;
+	}
 	
 	const float TargetFOV = bWantsToZoom ? CurrentWeapon->GetZoomedFOV() : DefaultFOV;
 
-	const float NewFOV = FMath::FInterpTo(CameraComp->FieldOfView, TargetFOV, DeltaTime, CurrentWeapon->GetZoomSpeed());
+	float NewFOV = FMath::FInterpTo(CameraComp->FieldOfView, TargetFOV, DeltaTime, CurrentWeapon->GetZoomSpeed());
+
+	// close enough, snap to it and stop ticking until the next zoom
+	if (FMath::IsNearlyEqual(NewFOV, TargetFOV, 0.1f))
+	{
+		NewFOV = TargetFOV;
+		StopZoomTick();
+	}
 
 	CameraComp->SetFieldOfView(NewFOV);
 }
 
-void ASCharacter::OnRep_Ability()
+void ASCharacter::StopZoomTick()
 {
-	// call animation stuff
+	if (!bBlueprintTicks)
+	{
+		SetActorTickEnabled(false);
+	}
+}
+
+void ASCharacter::OnAbilityActivated(USAbilityComponent* OwningAbilityComp, FName AbilityName)
+{
+	// runs on the server, the predicting owner and (through the ability comp's OnRep) simulated proxies
+	if (GetLocalRole() == ROLE_SimulatedProxy && USSignificanceSubsystem::GetSignificanceFor(this) == ESSignificance::Culled)
+	{
+		// purely cosmetic on proxies, nobody is going to see it
+		return;
+	}
+
+	if (AbilityName == PrimaryAbilityName)
+	{
+		PerformAbility();
+	}
+	else if (AbilityName == GetSCharacterMovement()->GetDodgeAbilityName())
+	{
+		PlayDodgeRoll();
+	}
 }
 
 
@@ -108,10 +284,12 @@ void ASCharacter::Tick(float DeltaTime)
 
 void ASCharacter::Zoom() {
 	bWantsToZoom = true;
+	SetActorTickEnabled(true);
 }
 
 void ASCharacter::Unzoom() {
 	bWantsToZoom = false;
+	SetActorTickEnabled(true);
 }
 
 void ASCharacter::StartFire()
@@ -146,33 +324,8 @@ void ASCharacter::StopReload()
 /** Function used to kickoff ability, the PERFORMABILITY function should contain actual ability logic for this character.*/
 void ASCharacter::StartAbility()
 {
-	if(GetLocalRole() < ROLE_Authority)
-		ServerStartAbility();
-	
-	if(GetWorld()->TimeSeconds - lastAbilityTime >= 0.0f)
-	{
-		//function used to replicate this will kick off the animations, need to run it locally for the owner though.
-		// I'm not going to have ability use stop shooting/reloading, so we don't care about the value of this we just want to trigger the repNotify.
-		bPendingAbility = !bPendingAbility;
-		PerformAbility();
-	}
-
-	GetWorldTimerManager().SetTimer(TimerHandle_AbilityTime, this, &ASCharacter::CompleteAbility, AbilityCooldown, false);
-}
-
-void ASCharacter::CompleteAbility()
-{
-	lastAbilityTime = GetWorld()->TimeSeconds;
-}
-
-void ASCharacter::ServerStartAbility_Implementation()
-{
-	StartAbility();
-}
-
-bool ASCharacter::ServerStartAbility_Validate()
-{
-	return true;
+	// cooldown and server validation live in the ability comp, PerformAbility is called back through OnAbilityActivated
+	AbilityComp->TryActivateAbility(PrimaryAbilityName);
 }
 
 void ASCharacter::OnHealthChanged(USHealthComponent * OwningHealthComp, float Health, float HealthDelta, const UDamageType * DamageType, AController * InstigatedBy, AActor * DamageCauser)
@@ -190,18 +343,82 @@ void ASCharacter::OnHealthChanged(USHealthComponent * OwningHealthComp, float He
 		
 		DetachFromControllerPendingDestroy();
 
-		SetLifeSpan(10.0f);
-
 		if(GetLocalRole() == ROLE_Authority)
 		{
 			ASGameMode* GM = Cast<ASGameMode>(GetWorld()->GetAuthGameMode());
 
-			GM->RestartDeadPlayer(PC);		
+			GM->RestartDeadPlayer(PC, HealthComp->TeamNum);
+
+			// the weapon stays in the corpse's hands on every client for as long as the corpse lives
+			if (CurrentWeapon)
+			{
+				CurrentWeapon->StopFire();
+				CurrentWeapon->TearOff();
+			}
+
+			// one last update carrying bDied, from here on clients own their copy as a local ragdoll
+			TearOff();
+
+			if (GetNetMode() == NM_DedicatedServer)
+			{
+				SetLifeSpan(ServerCorpseLifeSpan);
+			}
+			else
+			{
+				// TornOff isn't called on the server, the host needs its own corpse
+				StartRagdoll();
+			}
 		}
 		
 	}
 }
 
+void ASCharacter::TornOff()
+{
+	Super::TornOff();
+
+	StartRagdoll();
+}
+
+void ASCharacter::StartRagdoll()
+{
+	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	SetActorTickEnabled(false);
+
+	if (USSignificanceSubsystem* Significance = GetWorld()->GetSubsystem<USSignificanceSubsystem>())
+	{
+		// nobody is going to see it, skip the physics entirely
+		if (Significance->GetSignificance(this) == ESSignificance::Culled)
+		{
+			// a torn off client copy is its own authority, but on the server the tear off hasn't gone out yet
+			if (GetNetMode() == NM_Client)
+			{
+				Destroy();
+			}
+			else
+			{
+				SetLifeSpan(ServerCorpseLifeSpan);
+			}
+			return;
+		}
+
+		// corpses don't get throttled, a ragdoll ticking at a low rate looks broken
+		Significance->UnregisterCharacter(this);
+	}
+
+	USkeletalMeshComponent* MeshComp = GetMesh();
+	MeshComp->SetComponentTickInterval(0.0f);
+	MeshComp->SetCollisionProfileName(TEXT("Ragdoll"));
+	MeshComp->SetAllBodiesSimulatePhysics(true);
+	MeshComp->SetSimulatePhysics(true);
+	MeshComp->WakeAllRigidBodies();
+	MeshComp->bBlendPhysics = true;
+
+	GetWorld()->GetSubsystem<USCorpseSubsystem>()->RegisterCorpse(this);
+}
+
 // Called to bind functionality to input
 void ASCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -216,6 +433,11 @@ void ASCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponen
 	PlayerInputComponent->BindAction("Crouch", IE_Pressed, this, &ASCharacter::BeginCrouch);
 	PlayerInputComponent->BindAction("Crouch", IE_Released, this, &ASCharacter::EndCrouch);
 
+	PlayerInputComponent->BindAction("Sprint", IE_Pressed, this, &ASCharacter::BeginSprint);
+	PlayerInputComponent->BindAction("Sprint", IE_Released, this, &ASCharacter::EndSprint);
+
+	PlayerInputComponent->BindAction("Dodge", IE_Pressed, this, &ASCharacter::Dodge);
+
 	PlayerInputComponent->BindAction("Jump", IE_Pressed, this, &ACharacter::Jump);
 
 	PlayerInputComponent->BindAction("Zoom", IE_Pressed, this, &ASCharacter::Zoom);
@@ -225,6 +447,10 @@ void ASCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponen
 	PlayerInputComponent->BindAction("Fire", IE_Released, this, &ASCharacter::StopFire);
 
 	PlayerInputComponent->BindAction("Reload", IE_Pressed, this, &ASCharacter::StartReload);
+
+	PlayerInputComponent->BindAction("NextWeapon", IE_Pressed, this, &ASCharacter::NextWeapon);
+	PlayerInputComponent->BindAction("PreviousWeapon", IE_Pressed, this, &ASCharacter::PreviousWeapon);
+
 	PlayerInputComponent->BindAction("Ability", IE_Pressed, this, &ASCharacter::StartAbility);
 }
 
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SCorpseSubsystem.h"
+#include "GameFramework/Character.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Corpses"), STAT_SCCorpses, STATGROUP_ScoundrelCorp);
+
+int32 MaxCorpses = 8;
+FAutoConsoleVariableRef CVARMaxCorpses(
+	TEXT("SC.MaxCorpses"),
+	MaxCorpses,
+	TEXT("Ragdolls kept around at once, the oldest is removed when a new one comes in"),
+	ECVF_Default);
+
+float CorpseLifeSpan = 10.0f;
+FAutoConsoleVariableRef CVARCorpseLifeSpan(
+	TEXT("SC.CorpseLifeSpan"),
+	CorpseLifeSpan,
+	TEXT("Seconds a ragdoll stays around if the budget doesn't remove it first"),
+	ECVF_Default);
+
+void USCorpseSubsystem::RegisterCorpse(ACharacter* Corpse)
+{
+	if (Corpse == nullptr)
+	{
+		return;
+	}
+
+	Corpses.RemoveAll([](const TWeakObjectPtr<ACharacter>& Item) { return !Item.IsValid(); });
+
+	while (Corpses.Num() > 0 && Corpses.Num() >= MaxCorpses)
+	{
+		ACharacter* Oldest = Corpses[0].Get();
+		Corpses.RemoveAt(0);
+
+		Oldest->Destroy();
+	}
+
+	if (MaxCorpses <= 0)
+	{
+		Corpse->Destroy();
+		return;
+	}
+
+	Corpse->SetLifeSpan(CorpseLifeSpan);
+	Corpses.Add(Corpse);
+
+	SET_DWORD_STAT(STAT_SCCorpses, Corpses.Num());
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SCrosshairWidget.h"
+#include "SWeapon.h"
+
+USCrosshairWidget::USCrosshairWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	ReloadingOpacity = 0.3f;
+}
+
+void USCrosshairWidget::OnObservedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	// no crosshair while dead or spectating
+	SetVisibility(NewPawn ? ESlateVisibility::HitTestInvisible : ESlateVisibility::Collapsed);
+}
+
+void USCrosshairWidget::OnObservedWeaponChanged(ASWeapon* OldWeapon, ASWeapon* NewWeapon)
+{
+	if (OldWeapon)
+	{
+		OldWeapon->OnReloadStateChanged.RemoveDynamic(this, &USCrosshairWidget::HandleReloadStateChanged);
+	}
+
+	if (NewWeapon)
+	{
+		NewWeapon->OnReloadStateChanged.AddDynamic(this, &USCrosshairWidget::HandleReloadStateChanged);
+	}
+
+	UpdateCrosshair(NewWeapon != nullptr, NewWeapon && NewWeapon->IsReloading());
+}
+
+void USCrosshairWidget::HandleReloadStateChanged(ASWeapon* Weapon, bool bReloading)
+{
+	UpdateCrosshair(true, bReloading);
+}
+
+void USCrosshairWidget::UpdateCrosshair(bool bHasWeapon, bool bReloading)
+{
+	const float NewOpacity = (!bHasWeapon || bReloading) ? ReloadingOpacity : 1.0f;
+
+	if (!FMath::IsNearlyEqual(GetRenderOpacity(), NewOpacity))
+	{
+		SetRenderOpacity(NewOpacity);
+	}
+}
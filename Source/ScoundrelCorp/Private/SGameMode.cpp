@@ -2,29 +2,123 @@
 
 
 #include "SGameMode.h"
+#include "SGameState.h"
+#include "SPlayerState.h"
+#include "SPlayerController.h"
+#include "SSpawnSelectionSubsystem.h"
+#include "SMapPreloadSubsystem.h"
+#include "GameFramework/PlayerStart.h"
+#include "TimerManager.h"
+#include "Engine/World.h"
+#include "Engine/GameInstance.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
 #include "ScoundrelCorp/Components/SHealthComponent.h"
 
 ASGameMode::ASGameMode()
 {
-    PrimaryActorTick.bCanEverTick = true;
-    PrimaryActorTick.TickInterval = 1.0f;
+    GameStateClass = ASGameState::StaticClass();
+    PlayerStateClass = ASPlayerState::StaticClass();
+    PlayerControllerClass = ASPlayerController::StaticClass();
+
+    // player controllers and states come along to the next map, clients don't reconnect
+    bUseSeamlessTravel = true;
+
+    MapRotation.Add(FSoftObjectPath(TEXT("/Game/Level1.Level1")));
+    MapRotation.Add(FSoftObjectPath(TEXT("/Game/P_TestMap.P_TestMap")));
+
+    MatchDuration = 900.0f;
+    PreloadLeadTime = 120.0f;
+    MaxPreloadWait = 15.0f;
+    PreloadWaitTime = 0.0f;
+
+    RespawnDelay = 5.0f;
 }
 
 void ASGameMode::StartPlay()
 {
     Super::StartPlay();
+
+    OnActorKilled.AddDynamic(GetWorld()->GetSubsystem<USSpawnSelectionSubsystem>(), &USSpawnSelectionSubsystem::HandleActorKilled);
+
+    if (MatchDuration > 0.0f && MapRotation.Num() > 0)
+    {
+        GetWorldTimerManager().SetTimer(TimerHandle_PreloadNextMap, this, &ASGameMode::PreloadNextMap, FMath::Max(MatchDuration - PreloadLeadTime, 0.1f), false);
+        GetWorldTimerManager().SetTimer(TimerHandle_EndMatch, this, &ASGameMode::EndMatch, MatchDuration, false);
+    }
 }
 
-void ASGameMode::Tick(float DeltaSeconds)
+FSoftObjectPath ASGameMode::GetNextMap() const
 {
-    Super::Tick(DeltaSeconds);
+    const FString CurrentPackage = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+
+    const int32 CurrentIndex = MapRotation.IndexOfByPredicate([&CurrentPackage](const FSoftObjectPath& Map)
+    {
+        return Map.GetLongPackageName() == CurrentPackage;
+    });
+
+    // a map that isn't in the rotation starts it from the top
+    return MapRotation[(CurrentIndex + 1) % MapRotation.Num()];
 }
 
-void ASGameMode::RestartDeadPlayer(APlayerController* PC)
+void ASGameMode::PreloadNextMap()
 {
-    if(PC && PC->GetPawn() == nullptr)
+    ASGameState* GS = GetGameState<ASGameState>();
+    if (GS)
     {
-        RestartPlayer(PC);
+        // replicates to every client, each of them starts loading in the background as well
+        GS->SetNextMap(GetNextMap(), GS->GetServerWorldTimeSeconds() + GetWorldTimerManager().GetTimerRemaining(TimerHandle_EndMatch));
     }
 }
 
+void ASGameMode::EndMatch()
+{
+    const FSoftObjectPath NextMap = GetNextMap();
+
+    // a preload that's nearly done is worth a few seconds, travelling now would load the whole map in the transition
+    const USMapPreloadSubsystem* Preload = GetGameInstance() ? GetGameInstance()->GetSubsystem<USMapPreloadSubsystem>() : nullptr;
+    if (Preload && Preload->IsPreloadPending(NextMap) && PreloadWaitTime < MaxPreloadWait)
+    {
+        const float RetryInterval = 0.5f;
+        PreloadWaitTime += RetryInterval;
+
+        GetWorldTimerManager().SetTimer(TimerHandle_EndMatch, this, &ASGameMode::EndMatch, RetryInterval, false);
+        return;
+    }
+
+    UE_LOG(LogScoundrelCorp, Log, TEXT("Match over, travelling to %s"), *NextMap.GetLongPackageName());
+
+    // seamless, goes through the transition map while the preloaded one is brought up
+    GetWorld()->ServerTravel(NextMap.GetLongPackageName(), false);
+}
+
+void ASGameMode::RestartDeadPlayer(APlayerController* PC, uint8 TeamNum)
+{
+    if (RespawnDelay > 0.0f)
+    {
+        FTimerHandle TimerHandle_Respawn;
+        FTimerDelegate RespawnDelegate = FTimerDelegate::CreateUObject(this, &ASGameMode::RestartDeadPlayerNow, TWeakObjectPtr<APlayerController>(PC), TeamNum);
+
+        GetWorldTimerManager().SetTimer(TimerHandle_Respawn, RespawnDelegate, RespawnDelay, false);
+    }
+    else
+    {
+        RestartDeadPlayerNow(PC, TeamNum);
+    }
+}
+
+void ASGameMode::RestartDeadPlayerNow(TWeakObjectPtr<APlayerController> PC, uint8 TeamNum)
+{
+    if(PC.IsValid() && PC->GetPawn() == nullptr)
+    {
+        APlayerStart* Start = GetWorld()->GetSubsystem<USSpawnSelectionSubsystem>()->ChoosePlayerStart(TeamNum);
+
+        if (Start)
+        {
+            RestartPlayerAtPlayerStart(PC.Get(), Start);
+        }
+        else
+        {
+            RestartPlayer(PC.Get());
+        }
+    }
+}
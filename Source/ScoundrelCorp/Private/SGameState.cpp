@@ -0,0 +1,242 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SGameState.h"
+#include "SGameMode.h"
+#include "SPlayerState.h"
+#include "SMapPreloadSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
+
+void FSScoreboardEntry::PreReplicatedRemove(const FSScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryRemoved.Broadcast(InArraySerializer.Owner, PlayerState);
+	}
+}
+
+void FSScoreboardEntry::PostReplicatedAdd(const FSScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryChanged.Broadcast(InArraySerializer.Owner, *this);
+	}
+}
+
+void FSScoreboardEntry::PostReplicatedChange(const FSScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryChanged.Broadcast(InArraySerializer.Owner, *this);
+	}
+}
+
+void FSKillFeedEntry::PostReplicatedAdd(const FSKillFeed& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnKillFeedEntryAdded.Broadcast(InArraySerializer.Owner, *this);
+	}
+}
+
+ASGameState::ASGameState()
+{
+	MaxKillFeedEntries = 5;
+	MatchEndTime = 0.0f;
+
+	Scoreboard.Owner = this;
+	KillFeed.Owner = this;
+}
+
+void ASGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		ASGameMode* GM = Cast<ASGameMode>(GetWorld()->GetAuthGameMode());
+		if (GM)
+		{
+			GM->OnActorKilled.AddDynamic(this, &ASGameState::HandleActorKilled);
+		}
+	}
+}
+
+APlayerState* ASGameState::GetPlayerStateOf(AActor* Actor, AController* Controller)
+{
+	if (Controller && Controller->PlayerState)
+	{
+		return Controller->PlayerState;
+	}
+
+	// damage causers are usually weapons, owned by the pawn holding them
+	APawn* Pawn = Cast<APawn>(Actor);
+	if (Pawn == nullptr && Actor)
+	{
+		Pawn = Actor->GetInstigator() ? Actor->GetInstigator() : Cast<APawn>(Actor->GetOwner());
+	}
+
+	return Pawn ? Pawn->GetPlayerState() : nullptr;
+}
+
+FSScoreboardEntry* ASGameState::FindOrAddEntry(APlayerState* PlayerState)
+{
+	if (PlayerState == nullptr)
+	{
+		return nullptr;
+	}
+
+	FSScoreboardEntry* Entry = Scoreboard.Items.FindByPredicate([PlayerState](const FSScoreboardEntry& Item)
+	{
+		return Item.PlayerState == PlayerState;
+	});
+
+	if (Entry == nullptr)
+	{
+		Entry = &Scoreboard.Items.AddDefaulted_GetRef();
+		Entry->PlayerState = PlayerState;
+	}
+
+	return Entry;
+}
+
+void ASGameState::MarkEntryChanged(FSScoreboardEntry& Entry)
+{
+	Scoreboard.MarkItemDirty(Entry);
+
+	// fast array callbacks only run on clients
+	OnScoreboardEntryChanged.Broadcast(this, Entry);
+}
+
+void ASGameState::RecordDamage(AController* InstigatedBy, AActor* DamagedActor, float Damage)
+{
+	if (GetLocalRole() < ROLE_Authority || Damage <= 0.0f)
+	{
+		return;
+	}
+
+	APlayerState* InstigatorState = InstigatedBy ? InstigatedBy->PlayerState : nullptr;
+
+	// hurting yourself doesn't count
+	if (InstigatorState == nullptr || InstigatorState == GetPlayerStateOf(DamagedActor, nullptr))
+	{
+		return;
+	}
+
+	FSScoreboardEntry* Entry = FindOrAddEntry(InstigatorState);
+	Entry->Damage += Damage;
+	MarkEntryChanged(*Entry);
+
+	if (ASPlayerState* PS = Cast<ASPlayerState>(InstigatorState))
+	{
+		PS->TotalDamage += Damage;
+	}
+}
+
+void ASGameState::HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController)
+{
+	APlayerState* VictimState = GetPlayerStateOf(VictimActor, nullptr);
+	APlayerState* KillerState = GetPlayerStateOf(KillerActor, KillerController);
+
+	if (KillerState == VictimState)
+	{
+		KillerState = nullptr;
+	}
+
+	if (FSScoreboardEntry* VictimEntry = FindOrAddEntry(VictimState))
+	{
+		VictimEntry->Deaths++;
+		MarkEntryChanged(*VictimEntry);
+	}
+
+	if (ASPlayerState* PS = Cast<ASPlayerState>(VictimState))
+	{
+		PS->TotalDeaths++;
+	}
+
+	if (FSScoreboardEntry* KillerEntry = FindOrAddEntry(KillerState))
+	{
+		KillerEntry->Kills++;
+		MarkEntryChanged(*KillerEntry);
+	}
+
+	if (ASPlayerState* PS = Cast<ASPlayerState>(KillerState))
+	{
+		PS->TotalKills++;
+	}
+
+	if (VictimState == nullptr && KillerState == nullptr)
+	{
+		// bots killing bots, nobody wants to read that
+		return;
+	}
+
+	if (KillFeed.Items.Num() >= MaxKillFeedEntries)
+	{
+		KillFeed.Items.RemoveAt(0, KillFeed.Items.Num() - MaxKillFeedEntries + 1);
+		KillFeed.MarkArrayDirty();
+	}
+
+	FSKillFeedEntry& FeedEntry = KillFeed.Items.AddDefaulted_GetRef();
+	FeedEntry.Victim = VictimState;
+	FeedEntry.Killer = KillerState;
+	FeedEntry.ServerTime = GetServerWorldTimeSeconds();
+	KillFeed.MarkItemDirty(FeedEntry);
+
+	OnKillFeedEntryAdded.Broadcast(this, FeedEntry);
+}
+
+void ASGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	// clients get the removal through replication
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		Super::RemovePlayerState(PlayerState);
+		return;
+	}
+
+	const int32 NumRemoved = Scoreboard.Items.RemoveAll([PlayerState](const FSScoreboardEntry& Item)
+	{
+		return Item.PlayerState == PlayerState;
+	});
+
+	if (NumRemoved > 0)
+	{
+		Scoreboard.MarkArrayDirty();
+		OnScoreboardEntryRemoved.Broadcast(this, PlayerState);
+	}
+
+	Super::RemovePlayerState(PlayerState);
+}
+
+void ASGameState::SetNextMap(const FSoftObjectPath& InNextMap, float InMatchEndTime)
+{
+	NextMap = InNextMap;
+	MatchEndTime = InMatchEndTime;
+
+	// a listen server host preloads along with the dedicated server
+	OnRep_NextMap();
+}
+
+void ASGameState::OnRep_NextMap()
+{
+	USMapPreloadSubsystem* Preload = GetGameInstance() ? GetGameInstance()->GetSubsystem<USMapPreloadSubsystem>() : nullptr;
+	if (Preload)
+	{
+		Preload->PreloadMap(NextMap);
+	}
+}
+
+void ASGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASGameState, Scoreboard);
+	DOREPLIFETIME(ASGameState, KillFeed);
+	DOREPLIFETIME(ASGameState, NextMap);
+	DOREPLIFETIME(ASGameState, MatchEndTime);
+}
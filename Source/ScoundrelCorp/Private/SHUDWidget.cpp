@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SHUDWidget.h"
+#include "SCharacter.h"
+#include "SPlayerController.h"
+#include "SWeapon.h"
+
+void USHUDWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	if (ASPlayerController* PC = Cast<ASPlayerController>(GetOwningPlayer()))
+	{
+		PC->OnPawnChanged.AddDynamic(this, &USHUDWidget::HandlePawnChanged);
+	}
+
+	SetObservedPawn(GetOwningPlayerPawn());
+}
+
+void USHUDWidget::NativeDestruct()
+{
+	if (ASPlayerController* PC = Cast<ASPlayerController>(GetOwningPlayer()))
+	{
+		PC->OnPawnChanged.RemoveDynamic(this, &USHUDWidget::HandlePawnChanged);
+	}
+
+	SetObservedPawn(nullptr);
+
+	Super::NativeDestruct();
+}
+
+void USHUDWidget::HandlePawnChanged(ASPlayerController* PlayerController, APawn* NewPawn)
+{
+	SetObservedPawn(NewPawn);
+}
+
+void USHUDWidget::HandleCurrentWeaponChanged(ASCharacter* Character, ASWeapon* NewWeapon)
+{
+	SetObservedWeapon(NewWeapon);
+}
+
+void USHUDWidget::SetObservedPawn(APawn* NewPawn)
+{
+	APawn* OldPawn = ObservedPawn.Get();
+
+	if (OldPawn == NewPawn)
+	{
+		return;
+	}
+
+	if (ASCharacter* OldCharacter = Cast<ASCharacter>(OldPawn))
+	{
+		OldCharacter->OnCurrentWeaponChanged.RemoveDynamic(this, &USHUDWidget::HandleCurrentWeaponChanged);
+	}
+
+	ObservedPawn = NewPawn;
+
+	OnObservedPawnChanged(OldPawn, NewPawn);
+
+	ASCharacter* NewCharacter = Cast<ASCharacter>(NewPawn);
+
+	if (NewCharacter)
+	{
+		NewCharacter->OnCurrentWeaponChanged.AddDynamic(this, &USHUDWidget::HandleCurrentWeaponChanged);
+	}
+
+	// null until the weapon replicates in, the event above picks it up then
+	SetObservedWeapon(NewCharacter ? NewCharacter->GetCurrentWeapon() : nullptr);
+}
+
+void USHUDWidget::SetObservedWeapon(ASWeapon* NewWeapon)
+{
+	ASWeapon* OldWeapon = ObservedWeapon.Get();
+
+	if (OldWeapon == NewWeapon)
+	{
+		return;
+	}
+
+	ObservedWeapon = NewWeapon;
+
+	OnObservedWeaponChanged(OldWeapon, NewWeapon);
+}
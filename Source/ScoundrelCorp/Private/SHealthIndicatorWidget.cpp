@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SHealthIndicatorWidget.h"
+#include "Components/Image.h"
+#include "Materials/MaterialInstanceDynamic.h"
+#include "ScoundrelCorp/Components/SHealthComponent.h"
+#include "Widgets/SWidget.h"
+
+USHealthIndicatorWidget::USHealthIndicatorWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	HealthParameterName = TEXT("Health");
+	HealthMaterial = nullptr;
+	DisplayedHealthFraction = -1.0f;
+}
+
+void USHealthIndicatorWidget::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	HealthMaterial = HealthImage->GetDynamicMaterial();
+}
+
+void USHealthIndicatorWidget::OnObservedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	if (USHealthComponent* OldHealthComp = OldPawn ? OldPawn->FindComponentByClass<USHealthComponent>() : nullptr)
+	{
+		OldHealthComp->OnHealthChanged.RemoveDynamic(this, &USHealthIndicatorWidget::HandleHealthChanged);
+	}
+
+	USHealthComponent* NewHealthComp = NewPawn ? NewPawn->FindComponentByClass<USHealthComponent>() : nullptr;
+
+	if (NewHealthComp)
+	{
+		NewHealthComp->OnHealthChanged.AddDynamic(this, &USHealthIndicatorWidget::HandleHealthChanged);
+	}
+
+	UpdateHealth(NewHealthComp);
+}
+
+void USHealthIndicatorWidget::HandleHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser)
+{
+	UpdateHealth(OwningHealthComp);
+}
+
+void USHealthIndicatorWidget::UpdateHealth(const USHealthComponent* HealthComp)
+{
+	const float HealthFraction = (HealthComp && HealthComp->GetDefaultHealth() > 0.0f) ? FMath::Clamp(HealthComp->GetHealth() / HealthComp->GetDefaultHealth(), 0.0f, 1.0f) : 0.0f;
+
+	if (HealthMaterial == nullptr || FMath::IsNearlyEqual(HealthFraction, DisplayedHealthFraction))
+	{
+		return;
+	}
+
+	DisplayedHealthFraction = HealthFraction;
+
+	HealthMaterial->SetScalarParameterValue(HealthParameterName, HealthFraction);
+
+	// a parameter change isn't a widget change, an enclosing invalidation box has to be told to repaint
+	if (TSharedPtr<SWidget> SlateImage = HealthImage->GetCachedWidget())
+	{
+		SlateImage->Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SKillcamCamera.h"
+#include "Camera/CameraComponent.h"
+#include "GameFramework/PlayerController.h"
+
+// Sets default values
+ASKillcamCamera::ASKillcamCamera()
+{
+	// only ticks during playback
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	CameraComp = CreateDefaultSubobject<UCameraComponent>(TEXT("CameraComp"));
+	RootComponent = CameraComp;
+
+	SetReplicates(false);
+
+	ViewingPC = nullptr;
+	PlaybackTime = 0.0f;
+	NextShot = 0;
+	NextHealthChange = 0;
+}
+
+void ASKillcamCamera::StartPlayback(APlayerController* PC, const TArray<FSKillcamViewSample>& InViewSamples, const TArray<FSKillcamShot>& InShots, const TArray<FSKillcamHealthChange>& InHealthChanges)
+{
+	ViewingPC = PC;
+	ViewSamples = InViewSamples;
+	Shots = InShots;
+	HealthChanges = InHealthChanges;
+
+	// start where the killer's track starts
+	PlaybackTime = ViewSamples.Num() > 0 ? ViewSamples[0].Time : 0.0f;
+	NextShot = 0;
+	NextHealthChange = 0;
+
+	SetActorTickEnabled(true);
+
+	if (ViewingPC)
+	{
+		ViewingPC->SetViewTarget(this);
+	}
+}
+
+void ASKillcamCamera::StopPlayback()
+{
+	SetActorTickEnabled(false);
+
+	// the new pawn has taken the view over already if we respawned
+	if (ViewingPC && ViewingPC->GetViewTarget() == this)
+	{
+		ViewingPC->SetViewTarget(ViewingPC->GetPawn() ? (AActor*)ViewingPC->GetPawn() : (AActor*)ViewingPC);
+	}
+
+	ViewingPC = nullptr;
+
+	OnPlaybackFinished();
+}
+
+void ASKillcamCamera::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// respawned, or the view got taken over some other way
+	if (ViewingPC == nullptr || ViewingPC->GetViewTarget() != this || ViewSamples.Num() == 0)
+	{
+		StopPlayback();
+		return;
+	}
+
+	PlaybackTime += DeltaTime;
+
+	if (PlaybackTime >= ViewSamples.Last().Time)
+	{
+		StopPlayback();
+		return;
+	}
+
+	int32 SampleIndex = 0;
+	while (SampleIndex + 2 < ViewSamples.Num() && ViewSamples[SampleIndex + 1].Time <= PlaybackTime)
+	{
+		SampleIndex++;
+	}
+
+	const FSKillcamViewSample& From = ViewSamples[SampleIndex];
+	const FSKillcamViewSample& To = ViewSamples[SampleIndex + 1];
+	const float Alpha = FMath::Clamp((PlaybackTime - From.Time) / FMath::Max(To.Time - From.Time, KINDA_SMALL_NUMBER), 0.0f, 1.0f);
+
+	const FVector ViewLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+	SetActorLocationAndRotation(ViewLocation, FQuat::Slerp(From.Rotation.Quaternion(), To.Rotation.Quaternion(), Alpha));
+
+	while (Shots.IsValidIndex(NextShot) && Shots[NextShot].Time <= PlaybackTime)
+	{
+		OnReplayShot(ViewLocation, Shots[NextShot].TraceTo, Shots[NextShot].SurfaceType);
+		NextShot++;
+	}
+
+	while (HealthChanges.IsValidIndex(NextHealthChange) && HealthChanges[NextHealthChange].Time <= PlaybackTime)
+	{
+		OnReplayHealthChanged(HealthChanges[NextHealthChange].Health);
+		NextHealthChange++;
+	}
+}
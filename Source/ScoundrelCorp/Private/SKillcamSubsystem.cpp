@@ -0,0 +1,381 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SKillcamSubsystem.h"
+#include "SKillcamCamera.h"
+#include "SCharacter.h"
+#include "SGameState.h"
+#include "ScoundrelCorp/Components/SHealthComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_CYCLE_STAT(TEXT("Killcam Record"), STAT_SCKillcamRecord, STATGROUP_ScoundrelCorp);
+DECLARE_MEMORY_STAT(TEXT("Killcam Buffer"), STAT_SCKillcamBufferMemory, STATGROUP_ScoundrelCorp);
+
+int32 KillcamEnabled = 1;
+FAutoConsoleVariableRef CVARKillcamEnabled(
+	TEXT("SC.Killcam.Enabled"),
+	KillcamEnabled,
+	TEXT("Record the last seconds of the match and replay them when the local player dies"),
+	ECVF_Default);
+
+float KillcamDuration = 5.0f;
+FAutoConsoleVariableRef CVARKillcamDuration(
+	TEXT("SC.Killcam.Duration"),
+	KillcamDuration,
+	TEXT("Seconds kept in the killcam buffer"),
+	ECVF_Default);
+
+float KillcamSampleRate = 20.0f;
+FAutoConsoleVariableRef CVARKillcamSampleRate(
+	TEXT("SC.Killcam.SampleRate"),
+	KillcamSampleRate,
+	TEXT("Character transforms recorded per second, playback interpolates in between"),
+	ECVF_Default);
+
+namespace
+{
+	const float KillcamQuantization = 4.0f;
+
+	// eye height of a standing character, the packed transform is the actor location
+	const FVector KillcamEyeOffset(0.0f, 0.0f, 64.0f);
+}
+
+USKillcamSubsystem::USKillcamSubsystem()
+{
+	NextSlot = 0;
+	LocalPawnSlot = INDEX_NONE;
+	NextFrameIndex = 0;
+	TimeSinceFrame = 0.0f;
+	KillcamCamera = nullptr;
+}
+
+void USKillcamSubsystem::RegisterCharacter(ASCharacter* Character)
+{
+	if (Character == nullptr || GetWorld()->GetNetMode() == NM_DedicatedServer)
+	{
+		return;
+	}
+
+	GetSlot(Character);
+
+	// the host's own health never goes through OnRep_Health, the event covers clients and host alike
+	if (USHealthComponent* HealthComp = Character->FindComponentByClass<USHealthComponent>())
+	{
+		HealthComp->OnHealthChanged.AddDynamic(this, &USKillcamSubsystem::OnHealthChanged);
+	}
+}
+
+uint16 USKillcamSubsystem::GetSlot(const AActor* Actor)
+{
+	if (const uint16* Slot = Slots.Find(Actor))
+	{
+		return *Slot;
+	}
+
+	uint16 NewSlot;
+
+	// a released slot can only be reused once no frame or event in the buffer still mentions it
+	if (ReleasedSlots.Num() > 0 && ReleasedSlots[0].ReleaseTime < GetWorld()->GetTimeSeconds() - KillcamDuration)
+	{
+		NewSlot = ReleasedSlots[0].Slot;
+		ReleasedSlots.RemoveAt(0, 1, false);
+
+		for (auto It = PlayerSlots.CreateIterator(); It; ++It)
+		{
+			if (It.Value() == NewSlot || !It.Key().IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+	else
+	{
+		NewSlot = NextSlot++;
+	}
+
+	Slots.Add(Actor, NewSlot);
+	RememberPlayerSlot(Actor, NewSlot);
+
+	return NewSlot;
+}
+
+void USKillcamSubsystem::ReleaseSlot(uint16 Slot)
+{
+	FReleasedSlot& Released = ReleasedSlots.AddDefaulted_GetRef();
+	Released.Slot = Slot;
+	Released.ReleaseTime = GetWorld()->GetTimeSeconds();
+}
+
+void USKillcamSubsystem::RememberPlayerSlot(const AActor* Actor, uint16 Slot)
+{
+	const APawn* Pawn = Cast<APawn>(Actor);
+
+	if (Pawn && Pawn->GetPlayerState())
+	{
+		PlayerSlots.Add(Pawn->GetPlayerState(), Slot);
+	}
+}
+
+void USKillcamSubsystem::OnHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const UDamageType* DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	RecordHealth(OwningHealthComp->GetOwner(), Health);
+}
+
+void USKillcamSubsystem::RecordShot(const AActor* Shooter, const FVector& TraceTo, EPhysicalSurface SurfaceType)
+{
+	if (!KillcamEnabled || Shooter == nullptr)
+	{
+		return;
+	}
+
+	const uint16 ShooterSlot = GetSlot(Shooter);
+
+	// the killer's pawn can die in the same exchange, so the slot is tied to its player as the shots land
+	RememberPlayerSlot(Shooter, ShooterSlot);
+
+	FShotEvent& Shot = Shots.AddDefaulted_GetRef();
+	Shot.Time = GetWorld()->GetTimeSeconds();
+	Shot.Slot = ShooterSlot;
+	Shot.TraceTo = TraceTo;
+	Shot.SurfaceType = SurfaceType;
+}
+
+void USKillcamSubsystem::RecordHealth(const AActor* Owner, float Health)
+{
+	if (!KillcamEnabled || Owner == nullptr)
+	{
+		return;
+	}
+
+	FHealthEvent& Event = HealthEvents.AddDefaulted_GetRef();
+	Event.Time = GetWorld()->GetTimeSeconds();
+	Event.Slot = GetSlot(Owner);
+	Event.Health = (int16)FMath::Clamp(FMath::RoundToInt(Health), -32768, 32767);
+}
+
+void USKillcamSubsystem::RecordFrame()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCKillcamRecord);
+
+	const int32 NumFrames = FMath::Max(FMath::CeilToInt(KillcamDuration * KillcamSampleRate), 2);
+	if (Frames.Num() != NumFrames)
+	{
+		Frames.SetNum(NumFrames);
+		NextFrameIndex = 0;
+	}
+
+	FFrame& Frame = Frames[NextFrameIndex];
+	NextFrameIndex = (NextFrameIndex + 1) % NumFrames;
+
+	Frame.Time = GetWorld()->GetTimeSeconds();
+	Frame.Samples.Reset();
+
+	FBox Bounds(ForceInit);
+	for (auto It = Slots.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			ReleaseSlot(It.Value());
+			It.RemoveCurrent();
+			continue;
+		}
+
+		Bounds += It.Key()->GetActorLocation();
+	}
+
+	Frame.Origin = Bounds.IsValid ? Bounds.GetCenter() : FVector::ZeroVector;
+
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	if (PC && PC->GetPawn() && Slots.Contains(PC->GetPawn()))
+	{
+		LocalPawnSlot = Slots[PC->GetPawn()];
+	}
+
+	uint32 BufferBytes = 0;
+
+	for (const TPair<TWeakObjectPtr<const AActor>, uint16>& Slot : Slots)
+	{
+		const AActor* Actor = Slot.Key.Get();
+
+		// the pawn's view rotation for our own and the actor's for everyone else
+		const APawn* Pawn = Cast<APawn>(Actor);
+		const FRotator Rotation = Pawn ? Pawn->GetBaseAimRotation() : Actor->GetActorRotation();
+		const FVector Offset = (Actor->GetActorLocation() - Frame.Origin) / KillcamQuantization;
+
+		// player states replicate after the pawn, keep trying until we know whose pawn this is
+		RememberPlayerSlot(Actor, Slot.Value);
+
+		FPackedSample& Sample = Frame.Samples.AddDefaulted_GetRef();
+		Sample.Slot = Slot.Value;
+		Sample.X = (int16)FMath::Clamp(FMath::RoundToInt(Offset.X), -32768, 32767);
+		Sample.Y = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Y), -32768, 32767);
+		Sample.Z = (int16)FMath::Clamp(FMath::RoundToInt(Offset.Z), -32768, 32767);
+		Sample.Pitch = FRotator::CompressAxisToShort(Rotation.Pitch);
+		Sample.Yaw = FRotator::CompressAxisToShort(Rotation.Yaw);
+	}
+
+	for (const FFrame& Each : Frames)
+	{
+		BufferBytes += Each.Samples.GetAllocatedSize();
+	}
+	BufferBytes += Shots.GetAllocatedSize() + HealthEvents.GetAllocatedSize();
+
+	SET_MEMORY_STAT(STAT_SCKillcamBufferMemory, BufferBytes);
+}
+
+void USKillcamSubsystem::TrimEvents()
+{
+	const float OldestTime = GetWorld()->GetTimeSeconds() - KillcamDuration;
+
+	const int32 NumOldShots = Shots.IndexOfByPredicate([OldestTime](const FShotEvent& Shot) { return Shot.Time >= OldestTime; });
+	Shots.RemoveAt(0, NumOldShots == INDEX_NONE ? Shots.Num() : NumOldShots, false);
+
+	const int32 NumOldHealth = HealthEvents.IndexOfByPredicate([OldestTime](const FHealthEvent& Event) { return Event.Time >= OldestTime; });
+	HealthEvents.RemoveAt(0, NumOldHealth == INDEX_NONE ? HealthEvents.Num() : NumOldHealth, false);
+}
+
+void USKillcamSubsystem::BindToGameState()
+{
+	ASGameState* GS = GetWorld()->GetGameState<ASGameState>();
+
+	if (GS && GS != BoundGameState.Get())
+	{
+		GS->OnKillFeedEntryAdded.AddDynamic(this, &USKillcamSubsystem::OnKillFeedEntryAdded);
+		BoundGameState = GS;
+	}
+}
+
+void USKillcamSubsystem::OnKillFeedEntryAdded(ASGameState* GameState, const FSKillFeedEntry& Entry)
+{
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+	if (!KillcamEnabled || PC == nullptr || Entry.Victim == nullptr || Entry.Victim != PC->PlayerState || Entry.Killer == nullptr)
+	{
+		return;
+	}
+
+	// looked up by player rather than pawn, the killer may have died or been torn off in the meantime
+	const uint16* KillerSlot = PlayerSlots.Find(Entry.Killer);
+
+	if (KillerSlot)
+	{
+		StartKillcam(*KillerSlot);
+	}
+}
+
+void USKillcamSubsystem::StartKillcam(uint16 KillerSlot)
+{
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+
+	if (PC == nullptr || Frames.Num() == 0)
+	{
+		return;
+	}
+
+	// the victim's pawn has already been let go of by the time the kill feed arrives, use the last one we recorded
+	const int32 VictimSlot = LocalPawnSlot;
+
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float StartTime = Now - KillcamDuration;
+
+	// unpack the killer's track, oldest frame first
+	TArray<FSKillcamViewSample> ViewSamples;
+	for (int32 i = 0; i < Frames.Num(); i++)
+	{
+		const FFrame& Frame = Frames[(NextFrameIndex + i) % Frames.Num()];
+		if (Frame.Time < StartTime)
+		{
+			continue;
+		}
+
+		const FPackedSample* Sample = Frame.Samples.FindByPredicate([KillerSlot](const FPackedSample& Item) { return Item.Slot == KillerSlot; });
+		if (Sample == nullptr)
+		{
+			continue;
+		}
+
+		FSKillcamViewSample& ViewSample = ViewSamples.AddDefaulted_GetRef();
+		ViewSample.Time = Frame.Time - StartTime;
+		ViewSample.Location = Frame.Origin + FVector(Sample->X, Sample->Y, Sample->Z) * KillcamQuantization + KillcamEyeOffset;
+		ViewSample.Rotation = FRotator(FRotator::DecompressAxisFromShort(Sample->Pitch), FRotator::DecompressAxisFromShort(Sample->Yaw), 0.0f);
+	}
+
+	if (ViewSamples.Num() < 2)
+	{
+		return;
+	}
+
+	TArray<FSKillcamShot> ClipShots;
+	for (const FShotEvent& Shot : Shots)
+	{
+		if (Shot.Slot == KillerSlot && Shot.Time >= StartTime)
+		{
+			FSKillcamShot& ClipShot = ClipShots.AddDefaulted_GetRef();
+			ClipShot.Time = Shot.Time - StartTime;
+			ClipShot.TraceTo = Shot.TraceTo;
+			ClipShot.SurfaceType = (EPhysicalSurface)Shot.SurfaceType;
+		}
+	}
+
+	TArray<FSKillcamHealthChange> ClipHealthChanges;
+	for (const FHealthEvent& Event : HealthEvents)
+	{
+		if (Event.Slot == VictimSlot && Event.Time >= StartTime)
+		{
+			FSKillcamHealthChange& Change = ClipHealthChanges.AddDefaulted_GetRef();
+			Change.Time = Event.Time - StartTime;
+			Change.Health = Event.Health;
+		}
+	}
+
+	if (KillcamCamera == nullptr || KillcamCamera->IsPendingKill())
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		KillcamCamera = GetWorld()->SpawnActor<ASKillcamCamera>(SpawnParams);
+	}
+
+	if (KillcamCamera)
+	{
+		KillcamCamera->StartPlayback(PC, ViewSamples, ClipShots, ClipHealthChanges);
+	}
+}
+
+void USKillcamSubsystem::Tick(float DeltaTime)
+{
+	BindToGameState();
+
+	if (!KillcamEnabled)
+	{
+		return;
+	}
+
+	TimeSinceFrame += DeltaTime;
+	if (TimeSinceFrame >= 1.0f / FMath::Max(KillcamSampleRate, 1.0f))
+	{
+		TimeSinceFrame = 0.0f;
+		RecordFrame();
+		TrimEvents();
+	}
+}
+
+bool USKillcamSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() && GetWorld()->GetNetMode() != NM_DedicatedServer && Slots.Num() > 0;
+}
+
+TStatId USKillcamSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USKillcamSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USKillcamSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
@@ -0,0 +1,153 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SMapPreloadSubsystem.h"
+#include "SWeaponDefinition.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/WorldSettings.h"
+#include "UObject/Package.h"
+#include "UObject/UObjectGlobals.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+void USMapPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreloadedWorld = nullptr;
+	bMapLoadFailed = false;
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &USMapPreloadSubsystem::OnPostLoadMap);
+}
+
+void USMapPreloadSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+
+	ReleasePreloads();
+
+	Super::Deinitialize();
+}
+
+void USMapPreloadSubsystem::PreloadMap(const FSoftObjectPath& MapPath)
+{
+	if (!MapPath.IsValid() || MapPath == PreloadingMap)
+	{
+		return;
+	}
+
+	ReleasePreloads();
+	PreloadingMap = MapPath;
+
+	UE_LOG(LogScoundrelCorp, Log, TEXT("Preloading next map %s"), *MapPath.ToString());
+
+	LoadPackageAsync(MapPath.GetLongPackageName(), FLoadPackageAsyncDelegate::CreateUObject(this, &USMapPreloadSubsystem::OnMapPackageLoaded));
+
+	if (UAssetManager::IsValid())
+	{
+		// servers only need the tuning, everyone else wants the FX in the Client bundle as well
+		const UWorld* World = GetGameInstance()->GetWorld();
+		const bool bDedicatedServer = World && World->GetNetMode() == NM_DedicatedServer;
+
+		TArray<FName> Bundles;
+		if (!bDedicatedServer)
+		{
+			Bundles.Add(USWeaponDefinition::CosmeticBundleName);
+		}
+
+		AssetsHandle = UAssetManager::Get().LoadPrimaryAssetsWithType(USWeaponDefinition::PrimaryAssetType, Bundles, FStreamableDelegate(), FStreamableManager::AsyncLoadLowPriority);
+	}
+}
+
+bool USMapPreloadSubsystem::IsPreloadPending(const FSoftObjectPath& MapPath) const
+{
+	if (!MapPath.IsValid() || MapPath != PreloadingMap || bMapLoadFailed)
+	{
+		return false;
+	}
+
+	return PreloadedWorld == nullptr || (AssetsHandle.IsValid() && !AssetsHandle->HasLoadCompleted());
+}
+
+void USMapPreloadSubsystem::OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// a load for a map we've since moved on from
+	if (PackageName != FName(*PreloadingMap.GetLongPackageName()))
+	{
+		return;
+	}
+
+	UWorld* MapWorld = Result == EAsyncLoadingResult::Succeeded ? UWorld::FindWorldInPackage(LoadedPackage) : nullptr;
+
+	if (MapWorld == nullptr)
+	{
+		UE_LOG(LogScoundrelCorp, Warning, TEXT("Preloading %s failed, travel will load it the slow way"), *PackageName.ToString());
+		bMapLoadFailed = true;
+		return;
+	}
+
+	PreloadedWorld = MapWorld;
+
+	PreloadPawnClasses(MapWorld);
+
+	UE_LOG(LogScoundrelCorp, Log, TEXT("Next map %s is preloaded"), *PackageName.ToString());
+}
+
+void USMapPreloadSubsystem::PreloadPawnClasses(UWorld* MapWorld)
+{
+	// a game mode override in the map's world settings is a hard reference and came in with the package
+	AWorldSettings* MapSettings = MapWorld->GetWorldSettings(false, false);
+	UClass* GameModeClass = MapSettings ? MapSettings->DefaultGameMode.Get() : nullptr;
+
+	if (GameModeClass == nullptr)
+	{
+		// otherwise the travel keeps the current one, replicated so clients know it too
+		const UWorld* World = GetGameInstance()->GetWorld();
+		const AGameStateBase* GS = World ? World->GetGameState() : nullptr;
+		GameModeClass = GS ? GS->GameModeClass.Get() : nullptr;
+	}
+
+	if (GameModeClass == nullptr)
+	{
+		return;
+	}
+
+	// the pawn class brings its meshes, anim blueprint and starting weapon class along as hard references
+	UClass* PawnClass = GameModeClass->GetDefaultObject<AGameModeBase>()->DefaultPawnClass;
+
+	PreloadedClasses.AddUnique(GameModeClass);
+	if (PawnClass)
+	{
+		PreloadedClasses.AddUnique(PawnClass);
+	}
+
+	UE_LOG(LogScoundrelCorp, Log, TEXT("Next map spawns %s with %s"), *GetNameSafe(PawnClass), *GameModeClass->GetName());
+}
+
+void USMapPreloadSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	// the transition map loads first, hold on until the map we preloaded is the one that's up
+	if (LoadedWorld && PreloadingMap.IsValid() && UWorld::RemovePIEPrefix(LoadedWorld->GetOutermost()->GetName()) == PreloadingMap.GetLongPackageName())
+	{
+		ReleasePreloads();
+	}
+}
+
+void USMapPreloadSubsystem::ReleasePreloads()
+{
+	PreloadingMap.Reset();
+	PreloadedWorld = nullptr;
+	bMapLoadFailed = false;
+	PreloadedClasses.Reset();
+
+	if (AssetsHandle.IsValid())
+	{
+		// weapons in the new map hold on to their own definitions
+		AssetsHandle->ReleaseHandle();
+		AssetsHandle.Reset();
+	}
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SPlayerController.h"
+#include "ScoundrelCorp/Components/SClockSyncComponent.h"
+
+ASPlayerController::ASPlayerController()
+{
+	ClockSyncComp = CreateDefaultSubobject<USClockSyncComponent>(TEXT("ClockSyncComp"));
+}
+
+void ASPlayerController::NotifyLoadedWorld(FName WorldPackageName, bool bFinalDest)
+{
+	Super::NotifyLoadedWorld(WorldPackageName, bFinalDest);
+
+	if (bFinalDest)
+	{
+		ClockSyncComp->ResetSync();
+	}
+}
+
+void ASPlayerController::SetPawn(APawn* InPawn)
+{
+	Super::SetPawn(InPawn);
+
+	NotifyPawnChanged();
+}
+
+void ASPlayerController::OnRep_Pawn()
+{
+	Super::OnRep_Pawn();
+
+	NotifyPawnChanged();
+}
+
+void ASPlayerController::NotifyPawnChanged()
+{
+	// a pawn being destroyed still counts as the old one, so the change to null gets through
+	if (LastNotifiedPawn.Get(true) == GetPawn())
+	{
+		return;
+	}
+
+	LastNotifiedPawn = GetPawn();
+
+	OnPawnChanged.Broadcast(this, GetPawn());
+}
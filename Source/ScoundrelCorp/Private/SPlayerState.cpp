@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SPlayerState.h"
+#include "Net/UnrealNetwork.h"
+
+ASPlayerState::ASPlayerState()
+{
+	TotalKills = 0;
+	TotalDeaths = 0;
+	TotalDamage = 0.0f;
+}
+
+void ASPlayerState::CopyProperties(APlayerState* PlayerState)
+{
+	Super::CopyProperties(PlayerState);
+
+	ASPlayerState* NewPlayerState = Cast<ASPlayerState>(PlayerState);
+	if (NewPlayerState)
+	{
+		NewPlayerState->TotalKills = TotalKills;
+		NewPlayerState->TotalDeaths = TotalDeaths;
+		NewPlayerState->TotalDamage = TotalDamage;
+	}
+}
+
+void ASPlayerState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ASPlayerState, TotalKills);
+	DOREPLIFETIME(ASPlayerState, TotalDeaths);
+	DOREPLIFETIME(ASPlayerState, TotalDamage);
+}
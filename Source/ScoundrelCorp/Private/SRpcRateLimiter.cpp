@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SRpcRateLimiter.h"
+#include "GameFramework/Actor.h"
+#include "Engine/NetConnection.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+int32 RpcLimiterWarnEvery = 50;
+FAutoConsoleVariableRef CVARRpcLimiterWarnEvery(
+	TEXT("SC.RpcLimiter.WarnEvery"),
+	RpcLimiterWarnEvery,
+	TEXT("Log a warning every N dropped RPCs from the same connection"),
+	ECVF_Default);
+
+FAutoConsoleCommand CmdRpcLimiterReport(
+	TEXT("SC.RpcLimiter.Report"),
+	TEXT("Print accepted and dropped counts for rate limited server RPCs"),
+	FConsoleCommandDelegate::CreateStatic(&FSRpcRateLimitStats::Report));
+
+namespace
+{
+	struct FRpcCounters
+	{
+		uint64 Accepted = 0;
+		uint64 Dropped = 0;
+	};
+
+	TMap<FName, FRpcCounters> RpcCounters;
+
+	// drops per remote address, so a single abusive client stands out
+	TMap<FString, uint64> ConnectionDrops;
+
+	// addresses come and go for the life of the server, past this the quietest one is forgotten
+	const int32 MaxTrackedConnections = 256;
+}
+
+FSRpcTokenBucket::FSRpcTokenBucket()
+	: TokensPerSecond(1.0f)
+	, MaxTokens(1.0f)
+	, Tokens(1.0f)
+	, LastRefillTime(-1.0f)
+	, bConfigured(false)
+{
+}
+
+void FSRpcTokenBucket::Configure(float InTokensPerSecond, float InBurst)
+{
+	TokensPerSecond = FMath::Max(InTokensPerSecond, KINDA_SMALL_NUMBER);
+	MaxTokens = FMath::Max(InBurst, 1.0f);
+
+	if (!bConfigured)
+	{
+		Tokens = MaxTokens;
+		LastRefillTime = -1.0f;
+		bConfigured = true;
+	}
+	else
+	{
+		Tokens = FMath::Min(Tokens, MaxTokens);
+	}
+}
+
+bool FSRpcTokenBucket::TryConsume(float Now)
+{
+	// world time restarts after seamless travel, buckets on travelling actors just carry on from there
+	if (LastRefillTime >= 0.0f && Now >= LastRefillTime)
+	{
+		Tokens = FMath::Min(Tokens + (Now - LastRefillTime) * TokensPerSecond, MaxTokens);
+	}
+	LastRefillTime = Now;
+
+	if (Tokens < 1.0f)
+	{
+		return false;
+	}
+
+	Tokens -= 1.0f;
+	return true;
+}
+
+void FSRpcRateLimitStats::RecordAccepted(FName RpcName)
+{
+	RpcCounters.FindOrAdd(RpcName).Accepted++;
+}
+
+void FSRpcRateLimitStats::RecordDropped(const AActor* Actor, FName RpcName, const TCHAR* Reason)
+{
+	RpcCounters.FindOrAdd(RpcName).Dropped++;
+
+	UNetConnection* Connection = Actor ? Actor->GetNetConnection() : nullptr;
+	const FString Address = Connection ? Connection->LowLevelGetRemoteAddress(true) : TEXT("local");
+
+	uint64* FoundDrops = ConnectionDrops.Find(Address);
+
+	if (FoundDrops == nullptr)
+	{
+		if (ConnectionDrops.Num() >= MaxTrackedConnections)
+		{
+			const FString* Quietest = nullptr;
+			uint64 QuietestDrops = MAX_uint64;
+
+			for (const TPair<FString, uint64>& Pair : ConnectionDrops)
+			{
+				if (Pair.Value < QuietestDrops)
+				{
+					Quietest = &Pair.Key;
+					QuietestDrops = Pair.Value;
+				}
+			}
+
+			ConnectionDrops.Remove(FString(*Quietest));
+		}
+
+		FoundDrops = &ConnectionDrops.Add(Address, 0);
+	}
+
+	uint64& Drops = *FoundDrops;
+	Drops++;
+
+	if (RpcLimiterWarnEvery > 0 && (Drops - 1) % RpcLimiterWarnEvery == 0)
+	{
+		UE_LOG(LogScoundrelCorp, Warning, TEXT("Dropped %s from %s (%s): %s, %llu drops from this connection"),
+			*RpcName.ToString(), *Address, *GetNameSafe(Actor), Reason, Drops);
+	}
+}
+
+void FSRpcRateLimitStats::Report()
+{
+	for (const TPair<FName, FRpcCounters>& Pair : RpcCounters)
+	{
+		UE_LOG(LogScoundrelCorp, Display, TEXT("%s: %llu accepted, %llu dropped"), *Pair.Key.ToString(), Pair.Value.Accepted, Pair.Value.Dropped);
+	}
+
+	for (const TPair<FString, uint64>& Pair : ConnectionDrops)
+	{
+		UE_LOG(LogScoundrelCorp, Display, TEXT("  %s: %llu dropped"), *Pair.Key, Pair.Value);
+	}
+}
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SServerAnimationSubsystem.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_CYCLE_STAT(TEXT("Server Anim Forced Refresh"), STAT_SCServerAnimForcedRefresh, STATGROUP_ScoundrelCorp);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server Anim Budgeted Meshes"), STAT_SCServerAnimBudgetedMeshes, STATGROUP_ScoundrelCorp);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Server Anim Forced Refreshes"), STAT_SCServerAnimForcedRefreshes, STATGROUP_ScoundrelCorp);
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Server Anim Saved Per Player (ms)"), STAT_SCServerAnimSavedPerPlayer, STATGROUP_ScoundrelCorp);
+
+float ServerAnimRate = 10.0f;
+
+namespace
+{
+	// meshes pick the rate up when they register, the ones already playing need it pushed to them
+	void OnServerAnimRateChanged(IConsoleVariable* Var)
+	{
+		for (TObjectIterator<USServerAnimationSubsystem> It; It; ++It)
+		{
+			if (!It->HasAnyFlags(RF_ClassDefaultObject))
+			{
+				It->SetAnimRateScale(It->GetAnimRateScale());
+			}
+		}
+	}
+}
+
+FAutoConsoleVariableRef CVARServerAnimRate(
+	TEXT("SC.ServerAnim.Rate"),
+	ServerAnimRate,
+	TEXT("Fixed rate (Hz) character meshes are animated at on a dedicated server, hit queries refresh them in between"),
+	FConsoleVariableDelegate::CreateStatic(&OnServerAnimRateChanged),
+	ECVF_Default);
+
+USServerAnimationSubsystem::USServerAnimationSubsystem()
+{
+	AnimRateScale = 1.0f;
+	// a rough first guess until the first forced refresh is measured
+	AverageEvalSeconds = 0.0001;
+	ForcedRefreshesThisFrame = 0;
+}
+
+void USServerAnimationSubsystem::RegisterCharacterMesh(USkeletalMeshComponent* Mesh)
+{
+	if (Mesh == nullptr || GetWorld()->GetNetMode() != NM_DedicatedServer)
+	{
+		return;
+	}
+
+	// nothing renders on the server, so pose ticking has to be forced on and then throttled by tick interval
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+	ApplyTickInterval(Mesh);
+
+	BudgetedMeshes.AddUnique(Mesh);
+}
+
+void USServerAnimationSubsystem::UnregisterCharacterMesh(USkeletalMeshComponent* Mesh)
+{
+	BudgetedMeshes.RemoveSwap(Mesh);
+}
+
+void USServerAnimationSubsystem::ApplyWeaponMeshPolicy(USkeletalMeshComponent* Mesh)
+{
+	if (Mesh == nullptr || Mesh->GetNetMode() != NM_DedicatedServer)
+	{
+		return;
+	}
+
+	// the pose computed at registration stays valid for socket lookups
+	Mesh->bNoSkeletonUpdate = true;
+	Mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+	Mesh->SetComponentTickEnabled(false);
+}
+
+void USServerAnimationSubsystem::ApplyTickInterval(USkeletalMeshComponent* Mesh) const
+{
+	const float Rate = FMath::Max(ServerAnimRate * AnimRateScale, 1.0f);
+	Mesh->SetComponentTickInterval(1.0f / Rate);
+}
+
+void USServerAnimationSubsystem::SetAnimRateScale(float NewScale)
+{
+	AnimRateScale = FMath::Clamp(NewScale, 0.1f, 1.0f);
+
+	for (USkeletalMeshComponent* Mesh : BudgetedMeshes)
+	{
+		if (Mesh)
+		{
+			ApplyTickInterval(Mesh);
+		}
+	}
+}
+
+void USServerAnimationSubsystem::EnsurePosesForHitQuery(const FVector& TraceStart, const FVector& TraceEnd)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCServerAnimForcedRefresh);
+
+	for (USkeletalMeshComponent* Mesh : BudgetedMeshes)
+	{
+		if (Mesh == nullptr || Mesh->PoseTickedThisFrame())
+		{
+			continue;
+		}
+
+		const FBoxSphereBounds& Bounds = Mesh->Bounds;
+		if (FMath::PointDistToSegment(Bounds.Origin, TraceStart, TraceEnd) > Bounds.SphereRadius)
+		{
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		// zero delta re-runs the anim graph against the pawn's current state without advancing the regular interval tick
+		Mesh->TickAnimation(0.0f, false);
+		Mesh->RefreshBoneTransforms();
+		Mesh->UpdateKinematicBonesToAnim(Mesh->GetComponentSpaceTransforms(), ETeleportType::TeleportPhysics, false, EAllowKinematicDeferral::DisallowDeferral);
+
+		AverageEvalSeconds = FMath::Lerp(AverageEvalSeconds, FPlatformTime::Seconds() - StartTime, 0.1);
+		ForcedRefreshesThisFrame++;
+	}
+}
+
+void USServerAnimationSubsystem::Tick(float DeltaTime)
+{
+	BudgetedMeshes.RemoveAllSwap([](USkeletalMeshComponent* Mesh) { return Mesh == nullptr; });
+
+	const int32 NumMeshes = BudgetedMeshes.Num();
+
+	if (NumMeshes > 0)
+	{
+		// at full rate every mesh evaluates once a frame, on the budget only at the fixed rate plus forced refreshes
+		const float Rate = FMath::Max(ServerAnimRate * AnimRateScale, 1.0f);
+		const float ScheduledPerMesh = FMath::Min(Rate * DeltaTime, 1.0f);
+		const float ForcedPerMesh = (float)ForcedRefreshesThisFrame / NumMeshes;
+		const float AvoidedPerMesh = FMath::Max(1.0f - ScheduledPerMesh - ForcedPerMesh, 0.0f);
+
+		SET_FLOAT_STAT(STAT_SCServerAnimSavedPerPlayer, AvoidedPerMesh * AverageEvalSeconds * 1000.0);
+	}
+
+	SET_DWORD_STAT(STAT_SCServerAnimBudgetedMeshes, NumMeshes);
+	SET_DWORD_STAT(STAT_SCServerAnimForcedRefreshes, ForcedRefreshesThisFrame);
+
+	ForcedRefreshesThisFrame = 0;
+}
+
+bool USServerAnimationSubsystem::IsTickable() const
+{
+	return !IsTemplate() && BudgetedMeshes.Num() > 0;
+}
+
+TStatId USServerAnimationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USServerAnimationSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USServerAnimationSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
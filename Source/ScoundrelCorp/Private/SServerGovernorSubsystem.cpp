@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SServerGovernorSubsystem.h"
+#include "SCharacter.h"
+#include "SWeapon.h"
+#include "SServerAnimationSubsystem.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_FLOAT_COUNTER_STAT(TEXT("Governor Frame Time P95 (ms)"), STAT_SCGovernorFrameTimeP95, STATGROUP_ScoundrelCorp);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Governor Load Level"), STAT_SCGovernorLoadLevel, STATGROUP_ScoundrelCorp);
+
+int32 GovernorEnabled = 1;
+FAutoConsoleVariableRef CVARGovernorEnabled(
+	TEXT("SC.Governor.Enabled"),
+	GovernorEnabled,
+	TEXT("Shed server simulation quality when the frame time goes over budget"),
+	ECVF_Default);
+
+float GovernorTargetFrameMs = 25.0f;
+FAutoConsoleVariableRef CVARGovernorTargetFrameMs(
+	TEXT("SC.Governor.TargetFrameMs"),
+	GovernorTargetFrameMs,
+	TEXT("Server game thread budget in ms the frame time p95 is held against"),
+	ECVF_Default);
+
+float GovernorStepDownDelay = 1.0f;
+FAutoConsoleVariableRef CVARGovernorStepDownDelay(
+	TEXT("SC.Governor.StepDownDelay"),
+	GovernorStepDownDelay,
+	TEXT("Seconds over budget before the next level is shed"),
+	ECVF_Default);
+
+float GovernorRestoreDelay = 5.0f;
+FAutoConsoleVariableRef CVARGovernorRestoreDelay(
+	TEXT("SC.Governor.RestoreDelay"),
+	GovernorRestoreDelay,
+	TEXT("Seconds under RestoreFraction of the budget before a level is restored"),
+	ECVF_Default);
+
+float GovernorRestoreFraction = 0.75f;
+FAutoConsoleVariableRef CVARGovernorRestoreFraction(
+	TEXT("SC.Governor.RestoreFraction"),
+	GovernorRestoreFraction,
+	TEXT("Fraction of the budget the p95 has to stay under before a level is restored, keeps us from flapping"),
+	ECVF_Default);
+
+namespace
+{
+	const int32 GovernorSampleCount = 120;
+
+	const float GovernorEvaluationInterval = 0.25f;
+
+	// what each shed step sets its tunable to
+	const float ReducedNetRateScale = 0.5f;
+	const float ReducedAITickInterval = 0.2f;
+	const float ReducedAnimRateScale = 0.5f;
+}
+
+USServerGovernorSubsystem::USServerGovernorSubsystem()
+{
+	LoadLevel = ESServerLoadLevel::Normal;
+	NextSampleIndex = 0;
+	TimeSinceEvaluation = 0.0f;
+	TimeOverBudget = 0.0f;
+	TimeUnderBudget = 0.0f;
+}
+
+void USServerGovernorSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FrameTimeSamples.Reserve(GovernorSampleCount);
+
+	if (UWorld* World = GetWorld())
+	{
+		ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &USServerGovernorSubsystem::OnActorSpawned));
+	}
+}
+
+void USServerGovernorSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	Super::Deinitialize();
+}
+
+bool USServerGovernorSubsystem::IsServerWorld() const
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+
+	return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
+
+bool USServerGovernorSubsystem::AreServerCosmeticsAllowed(const UObject* WorldContextObject)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	USServerGovernorSubsystem* Governor = World ? World->GetSubsystem<USServerGovernorSubsystem>() : nullptr;
+
+	return Governor == nullptr || Governor->LoadLevel < ESServerLoadLevel::NoCosmetics;
+}
+
+void USServerGovernorSubsystem::Tick(float DeltaTime)
+{
+	// game thread work only, a dedicated server sleeps away the rest of its tick
+	const float FrameMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+	if (FrameTimeSamples.Num() < GovernorSampleCount)
+	{
+		FrameTimeSamples.Add(FrameMs);
+	}
+	else
+	{
+		FrameTimeSamples[NextSampleIndex] = FrameMs;
+	}
+	NextSampleIndex = (NextSampleIndex + 1) % GovernorSampleCount;
+
+	TimeSinceEvaluation += DeltaTime;
+	if (TimeSinceEvaluation < GovernorEvaluationInterval)
+	{
+		return;
+	}
+
+	const float EvaluatedTime = TimeSinceEvaluation;
+	TimeSinceEvaluation = 0.0f;
+
+	const float FrameTimeP95 = ComputeFrameTimePercentile(0.95f);
+
+	SET_FLOAT_STAT(STAT_SCGovernorFrameTimeP95, FrameTimeP95);
+	SET_DWORD_STAT(STAT_SCGovernorLoadLevel, (uint32)LoadLevel);
+
+	if (!GovernorEnabled)
+	{
+		if (LoadLevel != ESServerLoadLevel::Normal)
+		{
+			SetLoadLevel(ESServerLoadLevel::Normal, FrameTimeP95);
+		}
+		return;
+	}
+
+	if (FrameTimeP95 > GovernorTargetFrameMs)
+	{
+		TimeOverBudget += EvaluatedTime;
+		TimeUnderBudget = 0.0f;
+
+		if (TimeOverBudget >= GovernorStepDownDelay && LoadLevel < ESServerLoadLevel::NoCosmetics)
+		{
+			SetLoadLevel((ESServerLoadLevel)((uint8)LoadLevel + 1), FrameTimeP95);
+		}
+	}
+	else if (FrameTimeP95 < GovernorTargetFrameMs * GovernorRestoreFraction)
+	{
+		TimeUnderBudget += EvaluatedTime;
+		TimeOverBudget = 0.0f;
+
+		if (TimeUnderBudget >= GovernorRestoreDelay && LoadLevel > ESServerLoadLevel::Normal)
+		{
+			SetLoadLevel((ESServerLoadLevel)((uint8)LoadLevel - 1), FrameTimeP95);
+		}
+	}
+	else
+	{
+		// in the dead band, hold the current level
+		TimeOverBudget = 0.0f;
+		TimeUnderBudget = 0.0f;
+	}
+}
+
+float USServerGovernorSubsystem::ComputeFrameTimePercentile(float Percentile) const
+{
+	if (FrameTimeSamples.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	TArray<float> Sorted(FrameTimeSamples);
+	Sorted.Sort();
+
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+
+	return Sorted[Index];
+}
+
+void USServerGovernorSubsystem::SetLoadLevel(ESServerLoadLevel NewLevel, float FrameTimeP95)
+{
+	const ESServerLoadLevel OldLevel = LoadLevel;
+	LoadLevel = NewLevel;
+
+	TimeOverBudget = 0.0f;
+	TimeUnderBudget = 0.0f;
+
+	// logged with the world time so it can be lined up with kills, respawns etc.
+	UE_LOG(LogScoundrelCorp, Log, TEXT("Server governor: %s -> %s (frame p95 %.2f ms, budget %.2f ms, %d players, world time %.2f)"),
+		*StaticEnum<ESServerLoadLevel>()->GetNameStringByValue((int64)OldLevel),
+		*StaticEnum<ESServerLoadLevel>()->GetNameStringByValue((int64)NewLevel),
+		FrameTimeP95, GovernorTargetFrameMs, GetWorld()->GetNumPlayerControllers(), GetWorld()->GetTimeSeconds());
+
+	if (USServerAnimationSubsystem* ServerAnim = GetWorld()->GetSubsystem<USServerAnimationSubsystem>())
+	{
+		ServerAnim->SetAnimRateScale(LoadLevel >= ESServerLoadLevel::ReducedAnimRate ? ReducedAnimRateScale : 1.0f);
+	}
+
+	ApplyToAllActors();
+}
+
+void USServerGovernorSubsystem::ApplyToActor(AActor* Actor) const
+{
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	if (Actor->IsA<ASCharacter>() || Actor->IsA<ASWeapon>())
+	{
+		const AActor* Defaults = Actor->GetClass()->GetDefaultObject<AActor>();
+		const float Scale = LoadLevel >= ESServerLoadLevel::ReducedNetRate ? ReducedNetRateScale : 1.0f;
+
+		Actor->NetUpdateFrequency = Defaults->NetUpdateFrequency * Scale;
+		Actor->MinNetUpdateFrequency = FMath::Min(Defaults->MinNetUpdateFrequency * Scale, Actor->NetUpdateFrequency);
+		return;
+	}
+
+	// the AI's think rate is its controller's tick and that of its brain / path following components
+	AController* Controller = Cast<AController>(Actor);
+	if (Controller && !Controller->IsPlayerController())
+	{
+		const bool bReduced = LoadLevel >= ESServerLoadLevel::ReducedAIRate;
+
+		const AActor* Defaults = Controller->GetClass()->GetDefaultObject<AActor>();
+		Controller->SetActorTickInterval(bReduced ? FMath::Max(Defaults->PrimaryActorTick.TickInterval, ReducedAITickInterval) : Defaults->PrimaryActorTick.TickInterval);
+
+		for (UActorComponent* Component : Controller->GetComponents())
+		{
+			const UActorComponent* ComponentDefaults = Cast<UActorComponent>(Component->GetArchetype());
+			const float DefaultInterval = ComponentDefaults ? ComponentDefaults->PrimaryComponentTick.TickInterval : 0.0f;
+
+			Component->SetComponentTickInterval(bReduced ? FMath::Max(DefaultInterval, ReducedAITickInterval) : DefaultInterval);
+		}
+	}
+}
+
+void USServerGovernorSubsystem::ApplyToAllActors() const
+{
+	UWorld* World = GetWorld();
+
+	for (TActorIterator<ASCharacter> It(World); It; ++It)
+	{
+		ApplyToActor(*It);
+	}
+
+	for (TActorIterator<ASWeapon> It(World); It; ++It)
+	{
+		ApplyToActor(*It);
+	}
+
+	for (FConstControllerIterator It = World->GetControllerIterator(); It; ++It)
+	{
+		ApplyToActor(It->Get());
+	}
+}
+
+void USServerGovernorSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (LoadLevel != ESServerLoadLevel::Normal)
+	{
+		ApplyToActor(Actor);
+	}
+}
+
+bool USServerGovernorSubsystem::IsTickable() const
+{
+	return !IsTemplate() && GetWorld() && IsServerWorld();
+}
+
+TStatId USServerGovernorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USServerGovernorSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USServerGovernorSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
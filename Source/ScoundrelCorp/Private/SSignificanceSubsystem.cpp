@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSignificanceSubsystem.h"
+#include "SCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_SCSignificanceUpdate, STATGROUP_ScoundrelCorp);
+
+float SignificanceUpdateInterval = 0.25f;
+FAutoConsoleVariableRef CVARSignificanceUpdateInterval(
+	TEXT("SC.Significance.UpdateInterval"),
+	SignificanceUpdateInterval,
+	TEXT("Seconds between significance updates of remote characters"),
+	ECVF_Default);
+
+float SignificanceMaxDistance = 6000.0f;
+FAutoConsoleVariableRef CVARSignificanceMaxDistance(
+	TEXT("SC.Significance.MaxDistance"),
+	SignificanceMaxDistance,
+	TEXT("Distance at which a remote character reaches the lowest significance"),
+	ECVF_Default);
+
+int32 SignificanceEnabled = 1;
+FAutoConsoleVariableRef CVARSignificanceEnabled(
+	TEXT("SC.Significance.Enabled"),
+	SignificanceEnabled,
+	TEXT("Throttle remote characters by significance"),
+	ECVF_Default);
+
+namespace
+{
+	// actor tick and animation interval for each ESSignificance, indexed by the enum
+	const float SignificanceTickIntervals[] = { 0.5f, 0.1f, 0.033f, 0.0f };
+}
+
+USSignificanceSubsystem::USSignificanceSubsystem()
+{
+	TimeSinceUpdate = 0.0f;
+}
+
+void USSignificanceSubsystem::RegisterCharacter(ASCharacter* Character)
+{
+	// the server resolves hits against these meshes, a listen server host's camera must not slow their poses down
+	if (Character == nullptr || GetWorld()->GetNetMode() < NM_Client)
+	{
+		return;
+	}
+
+	Characters.Add(Character, ESSignificance::High);
+}
+
+void USSignificanceSubsystem::UnregisterCharacter(ASCharacter* Character)
+{
+	Characters.Remove(Character);
+}
+
+ESSignificance USSignificanceSubsystem::GetSignificance(const AActor* Actor) const
+{
+	const ASCharacter* Character = Cast<ASCharacter>(Actor);
+	if (Character == nullptr)
+	{
+		return ESSignificance::High;
+	}
+
+	const ESSignificance* Significance = Characters.Find(const_cast<ASCharacter*>(Character));
+
+	return Significance ? *Significance : ESSignificance::High;
+}
+
+ESSignificance USSignificanceSubsystem::GetSignificanceFor(const AActor* Actor)
+{
+	UWorld* World = Actor ? Actor->GetWorld() : nullptr;
+	USSignificanceSubsystem* Significance = World ? World->GetSubsystem<USSignificanceSubsystem>() : nullptr;
+
+	return Significance ? Significance->GetSignificance(Actor) : ESSignificance::High;
+}
+
+void USSignificanceSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceUpdate += DeltaTime;
+
+	if (TimeSinceUpdate >= SignificanceUpdateInterval)
+	{
+		TimeSinceUpdate = 0.0f;
+		UpdateSignificance();
+	}
+}
+
+void USSignificanceSubsystem::UpdateSignificance()
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCSignificanceUpdate);
+
+	APlayerController* PC = GetWorld()->GetFirstPlayerController();
+	if (PC == nullptr)
+	{
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PC->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const FVector ViewDirection = ViewRotation.Vector();
+
+	for (auto It = Characters.CreateIterator(); It; ++It)
+	{
+		ASCharacter* Character = It.Key().Get();
+		if (Character == nullptr)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		const ESSignificance NewSignificance = SignificanceEnabled ? ScoreCharacter(Character, ViewLocation, ViewDirection) : ESSignificance::High;
+
+		if (NewSignificance != It.Value())
+		{
+			It.Value() = NewSignificance;
+			ApplySignificance(Character, NewSignificance);
+		}
+	}
+}
+
+ESSignificance USSignificanceSubsystem::ScoreCharacter(const ASCharacter* Character, const FVector& ViewLocation, const FVector& ViewDirection) const
+{
+	// our own pawn and anything we are spectating through are always fully simulated
+	if (Character->IsLocallyControlled())
+	{
+		return ESSignificance::High;
+	}
+
+	const FVector ToCharacter = Character->GetActorLocation() - ViewLocation;
+	const float Distance = ToCharacter.Size();
+
+	const float DistanceScore = 1.0f - FMath::Clamp(Distance / SignificanceMaxDistance, 0.0f, 1.0f);
+
+	// characters behind the camera still matter a little, they can turn up on screen any moment
+	const float Dot = Distance > KINDA_SMALL_NUMBER ? FVector::DotProduct(ToCharacter / Distance, ViewDirection) : 1.0f;
+	const float AngleScore = FMath::GetMappedRangeValueClamped(FVector2D(-1.0f, 1.0f), FVector2D(0.25f, 1.0f), Dot);
+
+	// the renderer already did the occlusion test for us
+	const float OcclusionScore = Character->WasRecentlyRendered(SignificanceUpdateInterval) ? 1.0f : 0.25f;
+
+	const float Score = DistanceScore * AngleScore * OcclusionScore;
+
+	if (Score > 0.5f)
+	{
+		return ESSignificance::High;
+	}
+	if (Score > 0.2f)
+	{
+		return ESSignificance::Medium;
+	}
+	if (Score > 0.05f)
+	{
+		return ESSignificance::Low;
+	}
+	return ESSignificance::Culled;
+}
+
+void USSignificanceSubsystem::ApplySignificance(ASCharacter* Character, ESSignificance Significance) const
+{
+	const float TickInterval = SignificanceTickIntervals[(uint8)Significance];
+
+	Character->SetActorTickInterval(TickInterval);
+
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if (Mesh)
+	{
+		Mesh->SetComponentTickInterval(TickInterval);
+
+		// culled characters keep their montages going so notifies still fire, everything else goes back to the ACharacter default
+		Mesh->VisibilityBasedAnimTickOption = Significance == ESSignificance::Culled
+			? EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered
+			: EVisibilityBasedAnimTickOption::AlwaysTickPose;
+	}
+}
+
+bool USSignificanceSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Characters.Num() > 0;
+}
+
+TStatId USSignificanceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USSignificanceSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USSignificanceSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
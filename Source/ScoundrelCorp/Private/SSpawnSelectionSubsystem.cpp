@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSpawnSelectionSubsystem.h"
+#include "STargetingSubsystem.h"
+#include "Async/ParallelFor.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+
+DECLARE_CYCLE_STAT(TEXT("Spawn Selection Scoring"), STAT_SCSpawnScoring, STATGROUP_ScoundrelCorp);
+
+float SpawnScoreInterval = 0.25f;
+FAutoConsoleVariableRef CVARSpawnScoreInterval(
+	TEXT("SC.Spawn.ScoreInterval"),
+	SpawnScoreInterval,
+	TEXT("Seconds between re-scoring every player start"),
+	ECVF_Default);
+
+int32 SpawnStartsPerFrame = 4;
+FAutoConsoleVariableRef CVARSpawnStartsPerFrame(
+	TEXT("SC.Spawn.StartsPerFrame"),
+	SpawnStartsPerFrame,
+	TEXT("Player starts whose sight lines are re-traced each frame"),
+	ECVF_Default);
+
+float SpawnSafeDistance = 3000.0f;
+FAutoConsoleVariableRef CVARSpawnSafeDistance(
+	TEXT("SC.Spawn.SafeDistance"),
+	SpawnSafeDistance,
+	TEXT("Distance to the nearest hostile past which a start doesn't get any safer"),
+	ECVF_Default);
+
+float SpawnSightRange = 6000.0f;
+FAutoConsoleVariableRef CVARSpawnSightRange(
+	TEXT("SC.Spawn.SightRange"),
+	SpawnSightRange,
+	TEXT("Hostiles further away than this from a start aren't traced"),
+	ECVF_Default);
+
+namespace
+{
+	const float SeenByHostilePenalty = 0.5f;
+
+	const float HeatPenalty = 0.25f;
+
+	// a death adds one heat to starts within the radius, which halves every HeatHalfLife seconds
+	const float HeatRadius = 1500.0f;
+	const float HeatHalfLife = 10.0f;
+
+	// picking a start heats it up too, so simultaneous respawns spread out
+	const float ChosenStartHeat = 1.0f;
+
+	// eye height of someone standing on the start
+	const FVector StartEyeOffset(0.0f, 0.0f, 64.0f);
+}
+
+USSpawnSelectionSubsystem::USSpawnSelectionSubsystem()
+{
+	bGatheredCandidates = false;
+	NextCandidateIndex = 0;
+	TimeSinceScoring = 0.0f;
+}
+
+void USSpawnSelectionSubsystem::GatherCandidates()
+{
+	bGatheredCandidates = true;
+
+	for (TActorIterator<APlayerStart> It(GetWorld()); It; ++It)
+	{
+		FSpawnCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+		Candidate.PlayerStart = *It;
+		Candidate.Location = It->GetActorLocation();
+		Candidate.Heat = 0.0f;
+	}
+}
+
+APlayerStart* USSpawnSelectionSubsystem::ChoosePlayerStart(uint8 TeamNum)
+{
+	if (!bGatheredCandidates)
+	{
+		GatherCandidates();
+	}
+
+	const TArray<float>* Scores = CachedScores.Find(TeamNum);
+	if (Scores == nullptr || Scores->Num() != Candidates.Num())
+	{
+		// first respawn of a team we haven't seen yet, score it right away
+		TArray<FVector> Locations;
+		TArray<uint8> Teams;
+		GetWorld()->GetSubsystem<USTargetingSubsystem>()->GetLiveCharacters(Locations, Teams);
+
+		CachedScores.FindOrAdd(TeamNum);
+		RefreshScores(Locations, Teams);
+
+		Scores = CachedScores.Find(TeamNum);
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	for (int32 i = 0; i < Candidates.Num(); i++)
+	{
+		if (Candidates[i].PlayerStart.IsValid() && (BestIndex == INDEX_NONE || (*Scores)[i] > (*Scores)[BestIndex]))
+		{
+			BestIndex = i;
+		}
+	}
+
+	if (BestIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	Candidates[BestIndex].Heat += ChosenStartHeat;
+	for (TPair<uint8, TArray<float>>& TeamScores : CachedScores)
+	{
+		TeamScores.Value[BestIndex] -= ChosenStartHeat * HeatPenalty;
+	}
+
+	return Candidates[BestIndex].PlayerStart.Get();
+}
+
+void USSpawnSelectionSubsystem::HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController)
+{
+	if (VictimActor == nullptr)
+	{
+		return;
+	}
+
+	const FVector DeathLocation = VictimActor->GetActorLocation();
+
+	for (FSpawnCandidate& Candidate : Candidates)
+	{
+		if (FVector::DistSquared(Candidate.Location, DeathLocation) <= FMath::Square(HeatRadius))
+		{
+			Candidate.Heat += 1.0f;
+		}
+	}
+}
+
+void USSpawnSelectionSubsystem::ResolveSightTraces(FSpawnCandidate& Candidate) const
+{
+	if (Candidate.PendingTraces.Num() == 0)
+	{
+		return;
+	}
+
+	Candidate.SeenByTeams.Reset();
+
+	for (int32 i = 0; i < Candidate.PendingTraces.Num(); i++)
+	{
+		FTraceDatum Datum;
+
+		// a lost result counts as blocked, the start gets re-traced soon enough
+		if (GetWorld()->QueryTraceData(Candidate.PendingTraces[i], Datum) && Datum.OutHits.Num() == 0)
+		{
+			Candidate.SeenByTeams.Add(Candidate.PendingTraceTeams[i]);
+		}
+	}
+
+	Candidate.PendingTraces.Reset();
+	Candidate.PendingTraceTeams.Reset();
+}
+
+void USSpawnSelectionSubsystem::IssueSightTraces(FSpawnCandidate& Candidate, const TArray<FVector>& Locations, const TArray<uint8>& Teams) const
+{
+	const FVector Eye = Candidate.Location + StartEyeOffset;
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(SSpawnSight), false);
+
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		if (FVector::DistSquared(Eye, Locations[i]) > FMath::Square(SpawnSightRange))
+		{
+			continue;
+		}
+
+		// only static geometry, characters standing in the way don't make a start safe
+		Candidate.PendingTraces.Add(GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Eye, Locations[i], FCollisionObjectQueryParams(ECC_WorldStatic), QueryParams));
+		Candidate.PendingTraceTeams.Add(Teams[i]);
+	}
+}
+
+float USSpawnSelectionSubsystem::ScoreCandidate(const FSpawnCandidate& Candidate, uint8 TeamNum, const TArray<FVector>& Locations, const TArray<uint8>& Teams) const
+{
+	float NearestHostileSq = FMath::Square(SpawnSafeDistance);
+	for (int32 i = 0; i < Locations.Num(); i++)
+	{
+		if (USTargetingSubsystem::AreHostile(TeamNum, Teams[i]))
+		{
+			NearestHostileSq = FMath::Min(NearestHostileSq, FVector::DistSquared(Candidate.Location, Locations[i]));
+		}
+	}
+
+	int32 NumSeenBy = 0;
+	for (uint8 SeenByTeam : Candidate.SeenByTeams)
+	{
+		if (USTargetingSubsystem::AreHostile(TeamNum, SeenByTeam))
+		{
+			NumSeenBy++;
+		}
+	}
+
+	const float DistanceScore = FMath::Sqrt(NearestHostileSq) / SpawnSafeDistance;
+
+	return DistanceScore - NumSeenBy * SeenByHostilePenalty - Candidate.Heat * HeatPenalty;
+}
+
+void USSpawnSelectionSubsystem::RefreshScores(const TArray<FVector>& Locations, const TArray<uint8>& Teams)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCSpawnScoring);
+
+	// every team on the field might respawn, plus the ones that already asked
+	for (uint8 TeamNum : Teams)
+	{
+		CachedScores.FindOrAdd(TeamNum);
+	}
+
+	TArray<uint8> ScoredTeams;
+	CachedScores.GetKeys(ScoredTeams);
+
+	for (uint8 TeamNum : ScoredTeams)
+	{
+		CachedScores[TeamNum].SetNumUninitialized(Candidates.Num());
+	}
+
+	// each index only writes its own slot of every team's score array
+	ParallelFor(Candidates.Num(), [&](int32 CandidateIndex)
+	{
+		for (uint8 TeamNum : ScoredTeams)
+		{
+			CachedScores[TeamNum][CandidateIndex] = ScoreCandidate(Candidates[CandidateIndex], TeamNum, Locations, Teams);
+		}
+	});
+}
+
+void USSpawnSelectionSubsystem::Tick(float DeltaTime)
+{
+	if (!bGatheredCandidates)
+	{
+		GatherCandidates();
+	}
+
+	const int32 NumCandidates = Candidates.Num();
+	if (NumCandidates == 0)
+	{
+		return;
+	}
+
+	const float HeatDecay = FMath::Pow(0.5f, DeltaTime / HeatHalfLife);
+	for (FSpawnCandidate& Candidate : Candidates)
+	{
+		Candidate.Heat *= HeatDecay;
+		ResolveSightTraces(Candidate);
+	}
+
+	TArray<FVector> Locations;
+	TArray<uint8> Teams;
+	GetWorld()->GetSubsystem<USTargetingSubsystem>()->GetLiveCharacters(Locations, Teams);
+
+	// a few starts per frame, the async batch is picked up next frame
+	const int32 NumToTrace = FMath::Min(SpawnStartsPerFrame, NumCandidates);
+	for (int32 i = 0; i < NumToTrace; i++)
+	{
+		NextCandidateIndex = NextCandidateIndex % NumCandidates;
+		IssueSightTraces(Candidates[NextCandidateIndex], Locations, Teams);
+		NextCandidateIndex++;
+	}
+
+	TimeSinceScoring += DeltaTime;
+	if (TimeSinceScoring >= SpawnScoreInterval)
+	{
+		TimeSinceScoring = 0.0f;
+		RefreshScores(Locations, Teams);
+	}
+}
+
+bool USSpawnSelectionSubsystem::IsTickable() const
+{
+	// only the game mode respawns anyone
+	return !IsTemplate() && GetWorld() && GetWorld()->GetAuthGameMode() != nullptr;
+}
+
+TStatId USSpawnSelectionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USSpawnSelectionSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USSpawnSelectionSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
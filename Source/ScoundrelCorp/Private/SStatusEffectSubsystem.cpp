@@ -0,0 +1,184 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SStatusEffectSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+#include "ScoundrelCorp/Components/SHealthComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Status Effects Step"), STAT_SCStatusEffectsStep, STATGROUP_ScoundrelCorp);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Status Effects Active"), STAT_SCStatusEffectsActive, STATGROUP_ScoundrelCorp);
+
+float StatusEffectRate = 4.0f;
+FAutoConsoleVariableRef CVARStatusEffectRate(
+	TEXT("SC.StatusEffects.Rate"),
+	StatusEffectRate,
+	TEXT("Steps per second heals and damage over time are applied at"),
+	ECVF_Default);
+
+namespace
+{
+	// the net change of one actor over a step
+	struct FSNetHealthChange
+	{
+		float HealthChange;
+
+		// the largest damage effect gets the credit for the step
+		int32 DamageEffectIndex;
+
+		float LargestDamage;
+	};
+}
+
+USStatusEffectSubsystem::USStatusEffectSubsystem()
+{
+	StepAccumulator = 0.0f;
+}
+
+void USStatusEffectSubsystem::ApplyEffect(AActor* Target, float HealthPerSecond, float Duration, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser)
+{
+	if (Target == nullptr || Target->GetLocalRole() < ROLE_Authority || HealthPerSecond == 0.0f || Duration <= 0.0f)
+	{
+		return;
+	}
+
+	USHealthComponent* HealthComp = Target->FindComponentByClass<USHealthComponent>();
+	if (HealthComp == nullptr || HealthComp->IsDead())
+	{
+		return;
+	}
+
+	// same team rules as direct damage, self damage is allowed
+	if (HealthPerSecond < 0.0f && DamageCauser != Target && USHealthComponent::IsFriendly(Target, DamageCauser))
+	{
+		return;
+	}
+
+	Targets.Add(HealthComp);
+	Rates.Add(HealthPerSecond);
+	TimeRemaining.Add(Duration);
+	DamageTypes.Add(DamageType);
+	Instigators.Add(InstigatedBy);
+	Causers.Add(DamageCauser);
+}
+
+void USStatusEffectSubsystem::ClearEffects(AActor* Target)
+{
+	for (int32 i = Targets.Num() - 1; i >= 0; i--)
+	{
+		if (!Targets[i].IsValid() || Targets[i]->GetOwner() == Target)
+		{
+			RemoveEffectAt(i);
+		}
+	}
+}
+
+void USStatusEffectSubsystem::RemoveEffectAt(int32 Index)
+{
+	Targets.RemoveAtSwap(Index, 1, false);
+	Rates.RemoveAtSwap(Index, 1, false);
+	TimeRemaining.RemoveAtSwap(Index, 1, false);
+	DamageTypes.RemoveAtSwap(Index, 1, false);
+	Instigators.RemoveAtSwap(Index, 1, false);
+	Causers.RemoveAtSwap(Index, 1, false);
+}
+
+void USStatusEffectSubsystem::Step(float StepTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCStatusEffectsStep);
+
+	TMap<USHealthComponent*, FSNetHealthChange> NetChanges;
+	NetChanges.Reserve(Targets.Num());
+
+	for (int32 i = 0; i < Targets.Num(); i++)
+	{
+		USHealthComponent* HealthComp = Targets[i].Get();
+		if (HealthComp == nullptr || HealthComp->IsDead())
+		{
+			TimeRemaining[i] = 0.0f;
+			continue;
+		}
+
+		// the last step of an effect only applies what is left of its duration
+		const float AppliedTime = FMath::Min(StepTime, TimeRemaining[i]);
+		const float HealthChange = Rates[i] * AppliedTime;
+		TimeRemaining[i] -= AppliedTime;
+
+		FSNetHealthChange* NetChange = NetChanges.Find(HealthComp);
+		if (NetChange == nullptr)
+		{
+			NetChange = &NetChanges.Add(HealthComp, FSNetHealthChange{ 0.0f, INDEX_NONE, 0.0f });
+		}
+
+		NetChange->HealthChange += HealthChange;
+
+		if (-HealthChange > NetChange->LargestDamage)
+		{
+			NetChange->LargestDamage = -HealthChange;
+			NetChange->DamageEffectIndex = i;
+		}
+	}
+
+	for (const TPair<USHealthComponent*, FSNetHealthChange>& NetChange : NetChanges)
+	{
+		const int32 DamageIndex = NetChange.Value.DamageEffectIndex;
+
+		if (NetChange.Value.HealthChange < 0.0f && DamageIndex != INDEX_NONE)
+		{
+			const UDamageType* DamageType = DamageTypes[DamageIndex] ? DamageTypes[DamageIndex]->GetDefaultObject<UDamageType>() : GetDefault<UDamageType>();
+
+			NetChange.Key->ApplyHealthChange(NetChange.Value.HealthChange, DamageType, Instigators[DamageIndex].Get(), Causers[DamageIndex].Get());
+		}
+		else if (NetChange.Value.HealthChange > 0.0f)
+		{
+			NetChange.Key->ApplyHealthChange(NetChange.Value.HealthChange, nullptr, nullptr, nullptr);
+		}
+	}
+
+	for (int32 i = Targets.Num() - 1; i >= 0; i--)
+	{
+		if (TimeRemaining[i] <= 0.0f)
+		{
+			RemoveEffectAt(i);
+		}
+	}
+
+	SET_DWORD_STAT(STAT_SCStatusEffectsActive, Targets.Num());
+}
+
+void USStatusEffectSubsystem::Tick(float DeltaTime)
+{
+	const float StepTime = 1.0f / FMath::Max(StatusEffectRate, 0.1f);
+
+	// fixed steps, a hitch catches up a few of them rather than scaling a single step
+	StepAccumulator = FMath::Min(StepAccumulator + DeltaTime, StepTime * 4.0f);
+
+	while (StepAccumulator >= StepTime && Targets.Num() > 0)
+	{
+		StepAccumulator -= StepTime;
+		Step(StepTime);
+	}
+
+	if (Targets.Num() == 0)
+	{
+		StepAccumulator = 0.0f;
+	}
+}
+
+bool USStatusEffectSubsystem::IsTickable() const
+{
+	return !IsTemplate() && Targets.Num() > 0;
+}
+
+TStatId USStatusEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USStatusEffectSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USStatusEffectSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
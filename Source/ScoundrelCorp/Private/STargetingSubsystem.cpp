@@ -0,0 +1,337 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "STargetingSubsystem.h"
+#include "SCharacter.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "ScoundrelCorp/ScoundrelCorp.h"
+#include "ScoundrelCorp/Components/SHealthComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Targeting Update"), STAT_SCTargetingUpdate, STATGROUP_ScoundrelCorp);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting Sight Traces"), STAT_SCTargetingSightTraces, STATGROUP_ScoundrelCorp);
+
+float TargetingCellSize = 2000.0f;
+FAutoConsoleVariableRef CVARTargetingCellSize(
+	TEXT("SC.Targeting.CellSize"),
+	TargetingCellSize,
+	TEXT("Size of a spatial hash cell used for bot target queries"),
+	ECVF_Default);
+
+float TargetingRange = 5000.0f;
+FAutoConsoleVariableRef CVARTargetingRange(
+	TEXT("SC.Targeting.Range"),
+	TargetingRange,
+	TEXT("Distance bots look for targets at"),
+	ECVF_Default);
+
+float TargetingUpdateInterval = 0.2f;
+FAutoConsoleVariableRef CVARTargetingUpdateInterval(
+	TEXT("SC.Targeting.UpdateInterval"),
+	TargetingUpdateInterval,
+	TEXT("Seconds between target updates of a single bot, bots are spread across it"),
+	ECVF_Default);
+
+int32 TargetingMaxChecksPerSeeker = 3;
+FAutoConsoleVariableRef CVARTargetingMaxChecksPerSeeker(
+	TEXT("SC.Targeting.MaxChecksPerSeeker"),
+	TargetingMaxChecksPerSeeker,
+	TEXT("Nearest hostiles a bot traces line of sight to per update"),
+	ECVF_Default);
+
+USTargetingSubsystem::USTargetingSubsystem()
+{
+	NextSeekerIndex = 0;
+	SeekerBudget = 0.0f;
+}
+
+void USTargetingSubsystem::RegisterCharacter(ASCharacter* Character)
+{
+	if (Character && Character->GetLocalRole() == ROLE_Authority)
+	{
+		RegisteredCharacters.AddUnique(Character);
+	}
+}
+
+void USTargetingSubsystem::UnregisterCharacter(ASCharacter* Character)
+{
+	RegisteredCharacters.RemoveSwap(Character);
+
+	UnregisterSeeker(Character);
+}
+
+void USTargetingSubsystem::RegisterSeeker(ASCharacter* Seeker)
+{
+	if (Seeker == nullptr || Seeker->GetLocalRole() < ROLE_Authority)
+	{
+		return;
+	}
+
+	const bool bAlreadyRegistered = Seekers.ContainsByPredicate([Seeker](const FSeekerState& State)
+	{
+		return State.Seeker == Seeker;
+	});
+
+	if (!bAlreadyRegistered)
+	{
+		FSeekerState& State = Seekers.AddDefaulted_GetRef();
+		State.Seeker = Seeker;
+	}
+}
+
+void USTargetingSubsystem::UnregisterSeeker(ASCharacter* Seeker)
+{
+	Seekers.RemoveAllSwap([Seeker](const FSeekerState& State)
+	{
+		return State.Seeker == Seeker;
+	});
+}
+
+ASCharacter* USTargetingSubsystem::GetCurrentTarget(ASCharacter* Seeker) const
+{
+	const FSeekerState* State = Seekers.FindByPredicate([Seeker](const FSeekerState& Item)
+	{
+		return Item.Seeker == Seeker;
+	});
+
+	ASCharacter* Target = State ? State->CurrentTarget.Get() : nullptr;
+
+	// may have died since the last batch
+	return Target && !Target->IsDead() ? Target : nullptr;
+}
+
+ASCharacter* USTargetingSubsystem::FindNearestHostile(ASCharacter* Seeker, float MaxRange) const
+{
+	if (Seeker == nullptr)
+	{
+		return nullptr;
+	}
+
+	TArray<int32> Hostiles;
+	GatherHostiles(Seeker->GetActorLocation(), GetTeamOf(Seeker), Seeker, MaxRange, Hostiles);
+
+	return Hostiles.Num() > 0 ? Entries[Hostiles[0]].Character.Get() : nullptr;
+}
+
+void USTargetingSubsystem::GetLiveCharacters(TArray<FVector>& OutLocations, TArray<uint8>& OutTeams) const
+{
+	OutLocations.Reset(Entries.Num());
+	OutTeams.Reset(Entries.Num());
+
+	for (const FTargetEntry& Entry : Entries)
+	{
+		if (!Entry.Character.IsValid() || Entry.Character->IsDead())
+		{
+			continue;
+		}
+
+		OutLocations.Add(Entry.Location);
+		OutTeams.Add(Entry.TeamNum);
+	}
+}
+
+bool USTargetingSubsystem::AreHostile(uint8 TeamA, uint8 TeamB)
+{
+	// same rules as USHealthComponent::IsFriendly, team 0 is free for all
+	return (TeamA == 0 && TeamB == 0) || TeamA != TeamB;
+}
+
+uint8 USTargetingSubsystem::GetTeamOf(const ASCharacter* Character)
+{
+	const USHealthComponent* HealthComp = Character->FindComponentByClass<USHealthComponent>();
+
+	return HealthComp ? HealthComp->TeamNum : 0;
+}
+
+FIntVector USTargetingSubsystem::GetCell(const FVector& Location) const
+{
+	// flat 2D hash, the maps are not tall enough for a vertical split to pay off
+	return FIntVector(FMath::FloorToInt(Location.X / TargetingCellSize), FMath::FloorToInt(Location.Y / TargetingCellSize), 0);
+}
+
+void USTargetingSubsystem::RebuildSpatialHash()
+{
+	Entries.Reset();
+
+	// cells are kept around, characters tend to stay in the same parts of the map
+	for (TPair<FIntVector, TArray<int32>>& Cell : Cells)
+	{
+		Cell.Value.Reset();
+	}
+
+	RegisteredCharacters.RemoveAllSwap([](const TWeakObjectPtr<ASCharacter>& Character) { return !Character.IsValid(); });
+
+	for (const TWeakObjectPtr<ASCharacter>& Character : RegisteredCharacters)
+	{
+		if (Character->IsDead())
+		{
+			continue;
+		}
+
+		const int32 EntryIndex = Entries.AddDefaulted();
+		FTargetEntry& Entry = Entries[EntryIndex];
+		Entry.Character = Character;
+		Entry.Location = Character->GetActorLocation();
+		Entry.TeamNum = GetTeamOf(Character.Get());
+
+		Cells.FindOrAdd(GetCell(Entry.Location)).Add(EntryIndex);
+	}
+}
+
+void USTargetingSubsystem::GatherHostiles(const FVector& Origin, uint8 TeamNum, const ASCharacter* Ignore, float MaxRange, TArray<int32>& OutEntries) const
+{
+	OutEntries.Reset();
+
+	const float MaxRangeSq = FMath::Square(MaxRange);
+	const FIntVector MinCell = GetCell(Origin - FVector(MaxRange));
+	const FIntVector MaxCell = GetCell(Origin + FVector(MaxRange));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, 0));
+			if (Cell == nullptr)
+			{
+				continue;
+			}
+
+			for (int32 EntryIndex : *Cell)
+			{
+				const FTargetEntry& Entry = Entries[EntryIndex];
+
+				if (Entry.Character.Get() != Ignore && AreHostile(TeamNum, Entry.TeamNum) && FVector::DistSquared(Origin, Entry.Location) <= MaxRangeSq)
+				{
+					OutEntries.Add(EntryIndex);
+				}
+			}
+		}
+	}
+
+	OutEntries.Sort([this, &Origin](int32 A, int32 B)
+	{
+		return FVector::DistSquared(Origin, Entries[A].Location) < FVector::DistSquared(Origin, Entries[B].Location);
+	});
+}
+
+void USTargetingSubsystem::ResolveSightChecks(FSeekerState& State) const
+{
+	if (State.PendingChecks.Num() == 0)
+	{
+		return;
+	}
+
+	ASCharacter* NewTarget = nullptr;
+	bool bAllResolved = true;
+
+	for (const FSightCheck& Check : State.PendingChecks)
+	{
+		FTraceDatum Datum;
+		if (!GetWorld()->QueryTraceData(Check.TraceHandle, Datum))
+		{
+			bAllResolved = false;
+			continue;
+		}
+
+		// nothing in between, the target itself is ignored by the trace
+		if (Datum.OutHits.Num() == 0 && Check.Target.IsValid())
+		{
+			NewTarget = Check.Target.Get();
+			break;
+		}
+	}
+
+	// keep the old target if the batch got lost, e.g. across a hitch
+	if (NewTarget || bAllResolved)
+	{
+		State.CurrentTarget = NewTarget;
+	}
+
+	State.PendingChecks.Reset();
+}
+
+void USTargetingSubsystem::IssueSightChecks(FSeekerState& State)
+{
+	ASCharacter* Seeker = State.Seeker.Get();
+	if (Seeker == nullptr || Seeker->IsDead())
+	{
+		State.CurrentTarget = nullptr;
+		return;
+	}
+
+	const FVector EyeLocation = Seeker->GetPawnViewLocation();
+
+	TArray<int32> Hostiles;
+	GatherHostiles(Seeker->GetActorLocation(), GetTeamOf(Seeker), Seeker, TargetingRange, Hostiles);
+
+	const int32 NumChecks = FMath::Min(Hostiles.Num(), TargetingMaxChecksPerSeeker);
+
+	for (int32 i = 0; i < NumChecks; i++)
+	{
+		ASCharacter* Target = Entries[Hostiles[i]].Character.Get();
+
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(STargetingSight), false, Seeker);
+		QueryParams.AddIgnoredActor(Target);
+
+		FSightCheck& Check = State.PendingChecks.AddDefaulted_GetRef();
+		Check.Target = Target;
+		Check.TraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, EyeLocation, Target->GetPawnViewLocation(), ECC_Visibility, QueryParams);
+	}
+
+	if (NumChecks == 0)
+	{
+		State.CurrentTarget = nullptr;
+	}
+
+	INC_DWORD_STAT_BY(STAT_SCTargetingSightTraces, NumChecks);
+}
+
+void USTargetingSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_SCTargetingUpdate);
+
+	SET_DWORD_STAT(STAT_SCTargetingSightTraces, 0);
+
+	Seekers.RemoveAllSwap([](const FSeekerState& State) { return !State.Seeker.IsValid(); });
+
+	// last frame's batch has finished by now
+	for (FSeekerState& State : Seekers)
+	{
+		ResolveSightChecks(State);
+	}
+
+	RebuildSpatialHash();
+
+	const int32 NumSeekers = Seekers.Num();
+	if (NumSeekers == 0)
+	{
+		return;
+	}
+
+	// every seeker gets one update per interval, the fraction carries over so small bot counts still spread out
+	SeekerBudget += NumSeekers * DeltaTime / FMath::Max(TargetingUpdateInterval, 0.01f);
+	const int32 NumToUpdate = FMath::Min(FMath::FloorToInt(SeekerBudget), NumSeekers);
+	SeekerBudget = FMath::Min(SeekerBudget - NumToUpdate, 1.0f);
+
+	for (int32 i = 0; i < NumToUpdate; i++)
+	{
+		NextSeekerIndex = NextSeekerIndex % NumSeekers;
+		IssueSightChecks(Seekers[NextSeekerIndex]);
+		NextSeekerIndex++;
+	}
+}
+
+bool USTargetingSubsystem::IsTickable() const
+{
+	return !IsTemplate() && RegisteredCharacters.Num() > 0;
+}
+
+TStatId USTargetingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USTargetingSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* USTargetingSubsystem::GetTickableGameObjectWorld() const
+{
+	return GetWorld();
+}
@@ -11,6 +11,16 @@
 #include "TimerManager.h"
 #include "Net/UnrealNetwork.h"
 #include "ScoundrelCorp/Public/SCharacter.h"
+#include "SServerAnimationSubsystem.h"
+#include "SServerGovernorSubsystem.h"
+#include "SSignificanceSubsystem.h"
+#include "SKillcamSubsystem.h"
+#include "SClockSyncComponent.h"
+#include "SWeaponDefinition.h"
+#include "Camera/CameraShake.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/StreamableManager.h"
+#include "GameFramework/PlayerState.h"
 
 int32 DebugWeaponDrawing = 0;
 FAutoConsoleVariableRef CVARDebugWeaponDrawing(
@@ -19,11 +29,40 @@ FAutoConsoleVariableRef CVARDebugWeaponDrawing(
     TEXT("Draw Debug Lines for Weapons"),
     ECVF_Cheat);
 
+float ServerShotEyeTolerance = 25.0f;
+FAutoConsoleVariableRef CVARServerShotEyeTolerance(
+	TEXT("SC.Weapon.ServerShotEyeTolerance"),
+	ServerShotEyeTolerance,
+	TEXT("How far (cm) a standing client's shot may start from the server's view of its eyes before it is pulled back in, grows with speed times ping"),
+	ECVF_Default);
+
+float ServerShotMaxLatency = 0.3f;
+FAutoConsoleVariableRef CVARServerShotMaxLatency(
+	TEXT("SC.Weapon.ServerShotMaxLatency"),
+	ServerShotMaxLatency,
+	TEXT("Most ping (seconds) a client's shot eye location is allowed to lag or lead the server by"),
+	ECVF_Default);
+
+float ServerShotTimeTolerance = 0.25f;
+FAutoConsoleVariableRef CVARServerShotTimeTolerance(
+	TEXT("SC.Weapon.ServerShotTimeTolerance"),
+	ServerShotTimeTolerance,
+	TEXT("How far (seconds) a client's shot timestamp may run ahead of the server clock"),
+	ECVF_Default);
+
+namespace
+{
+	// a 30 Hz frame holds at most a handful of shots of any weapon we have, more than this is a modified client
+	const int32 MaxShotsPerBatch = 16;
+}
+
 // Sets default values
 ASWeapon::ASWeapon()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	// ticks only while the trigger is held, after movement so shots use this frame's view point
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
 
 	MeshComp = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("MeshComp"));
 	RootComponent = MeshComp;
@@ -34,14 +73,26 @@ ASWeapon::ASWeapon()
 	bPendingReload = false;
 	bIsFiring = false;
 	
-	BaseDamage = 20.0f;
-	HeadshotDamageMultiplier = 2.0f;
-	BulletSpread = 2.0f;
-	RateOfFire = 600;
-	ReloadTime = 1.0f;
-
 	CurrentAmmo = 0;
 	CurrentAmmoInMag = 0;
+
+	LastFireTime = -BIG_NUMBER;
+
+	LegacyDefinition = nullptr;
+	DefaultWeaponMesh = nullptr;
+
+	BaseDamage_DEPRECATED = 20.0f;
+	HeadshotDamageMultiplier_DEPRECATED = 2.0f;
+	BulletSpread_DEPRECATED = 2.0f;
+	RateOfFire_DEPRECATED = 600;
+	ReloadTime_DEPRECATED = 1.0f;
+	FireRateLimitBurst_DEPRECATED = 3.0f;
+	NextShotTime = 0.0f;
+	LastEyeLocation = FVector::ZeroVector;
+	LastEyeRotation = FQuat::Identity;
+	LastServerShotTime = -BIG_NUMBER;
+	NextShotIndex = 0;
+	LastReplayedShotCount = 0;
 	
 	SetReplicates(true);
 
@@ -53,10 +104,12 @@ void ASWeapon::PostInitializeComponents()
 {
 	Super::PostInitializeComponents();
 
-	if(InitialMags > 0)
+	const USWeaponDefinition* Definition = GetDefinition();
+
+	if(Definition->InitialMags > 0)
 	{
-		CurrentAmmoInMag = AmmoPerMag;
-		CurrentAmmo = AmmoPerMag * InitialMags;
+		CurrentAmmoInMag = Definition->AmmoPerMag;
+		CurrentAmmo = Definition->AmmoPerMag * Definition->InitialMags;
 	}
 }
 
@@ -65,16 +118,170 @@ void ASWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
-	TimeBetweenShots = 60 / RateOfFire;
+	DefaultWeaponMesh = MeshComp->SkeletalMesh;
+
+	ApplyDefinitionSettings();
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		ResetSpreadSeed();
+	}
+
+	USServerAnimationSubsystem::ApplyWeaponMeshPolicy(MeshComp);
+}
+
+void ASWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+	// only Blueprint defaults were ever saved with per weapon tuning, instances read it back through the class default
+	if (!HasAnyFlags(RF_ClassDefaultObject) || WeaponDefinition != nullptr)
+	{
+		return;
+	}
+
+	LegacyDefinition = NewObject<USWeaponDefinition>(this, TEXT("LegacyDefinition"), RF_Transient);
+	LegacyDefinition->DamageType = DamageType_DEPRECATED;
+	LegacyDefinition->BaseDamage = BaseDamage_DEPRECATED;
+	LegacyDefinition->HeadshotDamageMultiplier = HeadshotDamageMultiplier_DEPRECATED;
+	LegacyDefinition->RateOfFire = FMath::Max(RateOfFire_DEPRECATED, 1.0f);
+	LegacyDefinition->BulletSpread = BulletSpread_DEPRECATED;
+	LegacyDefinition->ZoomedFOV = ZoomedFOV_DEPRECATED;
+	LegacyDefinition->ZoomInterpSpeed = ZoomInterpSpeed_DEPRECATED;
+	LegacyDefinition->FireRateLimitBurst = FireRateLimitBurst_DEPRECATED;
+	LegacyDefinition->AmmoPerMag = AmmoPerMag_DEPRECATED;
+	LegacyDefinition->InitialMags = InitialMags_DEPRECATED;
+	LegacyDefinition->ReloadTime = ReloadTime_DEPRECATED;
+	LegacyDefinition->MuzzleEffect = MuzzleEffect_DEPRECATED;
+	LegacyDefinition->DefaultImpactEffect = DefaultImpactEffect_DEPRECATED;
+	LegacyDefinition->FleshImpactEffect = FleshImpactEffect_DEPRECATED;
+	LegacyDefinition->TracerEffect = TracerEffect_DEPRECATED;
+	LegacyDefinition->FireCamShake = FireCamShake_DEPRECATED.Get();
+
+	UE_LOG(LogScoundrelCorp, Warning, TEXT("%s has no WeaponDefinition, using its old per weapon tuning. Move it into a USWeaponDefinition asset."), *GetClass()->GetName());
+}
+
+void ASWeapon::ApplyDefinitionSettings()
+{
+	const USWeaponDefinition* Definition = GetDefinition();
+
+	TimeBetweenShots = Definition->GetTimeBetweenShots();
+
+	// FX stream in while we play, until then the effects are simply skipped
+	CosmeticsHandle = Definition->LoadCosmetics(this);
+
+	if (CosmeticsHandle.IsValid() && !CosmeticsHandle->HasLoadCompleted())
+	{
+		CosmeticsHandle->BindCompleteDelegate(FStreamableDelegate::CreateUObject(this, &ASWeapon::OnCosmeticsLoaded));
+	}
+	else
+	{
+		OnCosmeticsLoaded();
+	}
+
+	if (GetLocalRole() == ROLE_Authority)
+	{
+		// a little headroom over the real cadence so honest clients never hit the limit
+		FireRateLimit.Configure(1.1f / TimeBetweenShots, Definition->FireRateLimitBurst);
+		ReloadRateLimit.Configure(1.0f / FMath::Max(Definition->ReloadTime, 0.1f), 2.0f);
+	}
+}
+
+void ASWeapon::OnCosmeticsLoaded()
+{
+	USkeletalMesh* NewMesh = GetDefinition()->WeaponMesh.Get();
+
+	if (NewMesh == nullptr && GetDefinition()->WeaponMesh.IsNull())
+	{
+		NewMesh = DefaultWeaponMesh;
+	}
+
+	if (NewMesh && NewMesh != MeshComp->SkeletalMesh)
+	{
+		MeshComp->SetSkeletalMesh(NewMesh);
+	}
+}
+
+void ASWeapon::OnRep_WeaponDefinition()
+{
+	ApplyDefinitionSettings();
+}
+
+void ASWeapon::EquipDefinition(USWeaponDefinition* NewDefinition, int32 NewCurrentAmmo, int32 NewCurrentAmmoInMag)
+{
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		return;
+	}
+
+	// whatever the old weapon was doing doesn't carry over
+	StopFire();
+	StopReload();
+	SetPendingReload(false);
+
+	WeaponDefinition = NewDefinition;
+	CurrentAmmo = NewCurrentAmmo;
+	CurrentAmmoInMag = NewCurrentAmmoInMag;
+
+	ApplyDefinitionSettings();
+
+	ResetSpreadSeed();
+
+	OnAmmoChanged.Broadcast(this, CurrentAmmoInMag, CurrentAmmo);
+}
+
+void ASWeapon::ResetSpreadSeed()
+{
+	SpreadSeed.Seed = FMath::Rand();
+	SpreadSeed.Epoch++;
+	NextShotIndex = 0;
+}
+
+void ASWeapon::OnRep_SpreadSeed()
+{
+	NextShotIndex = 0;
 }
 
-void ASWeapon::OnRep_HitScanTrace()
+void ASWeapon::OnRep_HitScanHistory()
 {
-	// play cosmetic FX
-	PlayFireEffects(HitScanTrace.TraceTo);
+	const int32 HistorySize = HitScanHistory.Traces.Num();
+
+	// shots from before we saw this weapon aren't replayed, the first update only syncs the count
+	const int32 NewShots = HasActorBegunPlay() && HistorySize > 0 ? FMath::Min<int32>((uint16)(HitScanHistory.ShotCount - LastReplayedShotCount), HistorySize) : 0;
 
-	PlayImpactEffects(HitScanTrace.SurfaceType, HitScanTrace.TraceTo);
+	LastReplayedShotCount = HitScanHistory.ShotCount;
 
+	// oldest first, walking back from the newest shot's slot
+	for (int32 Age = NewShots; Age > 0; --Age)
+	{
+		const uint16 ShotNumber = HitScanHistory.ShotCount - Age;
+		ReplayHitScanTrace(HitScanHistory.Traces[ShotNumber % HistorySize]);
+	}
+}
+
+void ASWeapon::ReplayHitScanTrace(const FHitScanTrace& Trace)
+{
+	// recorded even for shooters we don't draw, the killcam may need them
+	if (USKillcamSubsystem* Killcam = GetWorld()->GetSubsystem<USKillcamSubsystem>())
+	{
+		Killcam->RecordShot(GetOwner(), Trace.TraceTo, Trace.SurfaceType);
+	}
+
+	// play cosmetic FX, scaled down for shooters the local player can barely see
+	const ESSignificance Significance = USSignificanceSubsystem::GetSignificanceFor(GetOwner());
+
+	if (Significance == ESSignificance::Culled)
+	{
+		return;
+	}
+
+	if (Significance != ESSignificance::Low)
+	{
+		PlayFireEffects(Trace.TraceTo);
+	}
+
+	// impacts can land right next to us even when the shooter is far away
+	PlayImpactEffects(Trace.SurfaceType, Trace.TraceTo);
 }
 
 bool ASWeapon::CanFire() const
@@ -85,7 +292,7 @@ bool ASWeapon::CanFire() const
 
 bool ASWeapon::CanReload() const
 {
-	bool bGotAmmo = (CurrentAmmoInMag < AmmoPerMag) && (CurrentAmmo - CurrentAmmoInMag > 0);
+	bool bGotAmmo = (CurrentAmmoInMag < GetDefinition()->AmmoPerMag) && (CurrentAmmo - CurrentAmmoInMag > 0);
 	//we should always be able to cancel what we are doing into a reload.
 	return bGotAmmo == true;
 }
@@ -93,115 +300,353 @@ bool ASWeapon::CanReload() const
 void ASWeapon::OnRep_Reload()
 {
 	// play effects here (probably gotta check that it is true and not false)
-	
+	OnReloadStateChanged.Broadcast(this, bPendingReload);
 }
 
-void ASWeapon::Fire()
+void ASWeapon::OnRep_Ammo()
 {
-	// trace the world, from pawn eyes to crosshair position
-	if (GetLocalRole() < ROLE_Authority) {
-		ServerFire();
+	// both ammo counts usually arrive in the same bunch, the second OnRep repeats the same values
+	OnAmmoChanged.Broadcast(this, CurrentAmmoInMag, CurrentAmmo);
+}
+
+void ASWeapon::SetPendingReload(bool bNewPendingReload)
+{
+	if (bPendingReload == bNewPendingReload)
+	{
+		return;
 	}
 
-	if(!CanFire())
+	bPendingReload = bNewPendingReload;
+
+	OnReloadStateChanged.Broadcast(this, bPendingReload);
+}
+
+void ASWeapon::Fire()
+{
+	AActor* MyOwner = GetOwner();
+
+	// checked before the RPC so an empty or reloading weapon doesn't spend the server's fire budget
+	if (MyOwner == nullptr || !CanFire())
+	{
 		return;
+	}
+
+	FVector EyeLocation;
+	FRotator EyeRotation;
 
+	MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	TArray<FSWeaponShot> Shots;
+	FSWeaponShot& Shot = Shots.AddDefaulted_GetRef();
+	Shot.ShotTime = USClockSyncComponent::GetServerTime(this);
+	Shot.EyeLocation = EyeLocation;
+	Shot.AimDirection = EyeRotation.Vector();
+
+	LastFireTime = GetWorld()->TimeSeconds;
+
+	SubmitShots(Shots);
+}
+
+void ASWeapon::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
 
 	AActor* MyOwner = GetOwner();
 
-	if (MyOwner) 
+	if (MyOwner == nullptr)
 	{
-		FVector EyeLocation;
-		FRotator EyeRotation;
+		StopFire();
+		return;
+	}
 
-		MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+	FVector EyeLocation;
+	FRotator EyeRotation;
 
-		FVector ShotDirection = EyeRotation.Vector();
+	MyOwner->GetActorEyesViewPoint(EyeLocation, EyeRotation);
 
-		// bullet spread 
-		float HalfRad = FMath::DegreesToRadians(BulletSpread);
-		ShotDirection = FMath::VRandCone(ShotDirection, HalfRad, HalfRad);
+	const FQuat EyeQuat = EyeRotation.Quaternion();
+	const float Now = GetWorld()->TimeSeconds;
+	const float FrameStart = Now - DeltaTime;
 
-		FVector TraceEnd = EyeLocation + (ShotDirection * 10000);
+	// local to server time, so the shot timestamps line up with the server's clock
+	const float ServerTimeOffset = USClockSyncComponent::GetServerTime(this) - Now;
 
-		FCollisionQueryParams QueryParams;
-		QueryParams.AddIgnoredActor(MyOwner);
-		QueryParams.AddIgnoredActor(this);
-		QueryParams.bTraceComplex = true;
-		QueryParams.bReturnPhysicalMaterial = true;
+	// a reload in flight still lets us shoot the rounds the owner hasn't been told about yet, just like before
+	const int32 AvailableShots = CanFire() ? FMath::Min(CurrentAmmoInMag, MaxShotsPerBatch) : 0;
 
-		FHitResult Hit;
+	TArray<FSWeaponShot> Shots;
 
-		// particle "Target" parameter
-		FVector TracerEndPoint = TraceEnd;
+	while (NextShotTime <= Now && Shots.Num() < AvailableShots)
+	{
+		// where inside this frame the shot falls, shots held back from earlier frames start at its beginning
+		const float Alpha = DeltaTime > 0.0f ? FMath::Clamp((NextShotTime - FrameStart) / DeltaTime, 0.0f, 1.0f) : 1.0f;
 
-		EPhysicalSurface SurfaceType = SurfaceType_Default;
-		
+		FSWeaponShot& Shot = Shots.AddDefaulted_GetRef();
+		Shot.ShotTime = FMath::Max(NextShotTime, FrameStart) + ServerTimeOffset;
+		Shot.EyeLocation = FMath::Lerp(LastEyeLocation, EyeLocation, Alpha);
+		Shot.AimDirection = FQuat::Slerp(LastEyeRotation, EyeQuat, Alpha).Vector();
 
-		if (GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_WEAPON, QueryParams))
-		{
-			// blocking hit! Process damage
-			AActor* HitActor = Hit.GetActor();
+		LastFireTime = NextShotTime;
+		NextShotTime += TimeBetweenShots;
+	}
 
-			SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+	// an empty mag or a long hitch doesn't bank shots for later
+	NextShotTime = FMath::Max(NextShotTime, FrameStart);
 
-			float ActualDamage = (SurfaceType == SURFACE_FLESHVULNERABLE) ? BaseDamage * HeadshotDamageMultiplier : BaseDamage;
+	LastEyeLocation = EyeLocation;
+	LastEyeRotation = EyeQuat;
+
+	if (Shots.Num() > 0)
+	{
+		SubmitShots(Shots);
+	}
+}
 
+void ASWeapon::SubmitShots(TArray<FSWeaponShot>& Shots)
+{
+	for (FSWeaponShot& Shot : Shots)
+	{
+		Shot.SpreadEpoch = SpreadSeed.Epoch;
+		Shot.ShotIndex = NextShotIndex++;
+	}
 
-			UGameplayStatics::ApplyPointDamage(HitActor, ActualDamage, ShotDirection, Hit, MyOwner->GetInstigatorController(), MyOwner, DamageType);
+	if (GetLocalRole() < ROLE_Authority)
+	{
+		ServerFireBatch(Shots);
+	}
 
-			PlayImpactEffects(SurfaceType, Hit.ImpactPoint);
+	for (const FSWeaponShot& Shot : Shots)
+	{
+		FireShot(Shot);
+	}
+}
 
-			TracerEndPoint = Hit.ImpactPoint;
+void ASWeapon::FireShot(const FSWeaponShot& Shot)
+{
+	AActor* MyOwner = GetOwner();
 
-			
-		}
+	if (MyOwner == nullptr)
+	{
+		return;
+	}
 
-		if (DebugWeaponDrawing > 0) {
-			DrawDebugLine(GetWorld(), EyeLocation, TraceEnd, FColor::Red, false, 1.0, 0, 1.0f);
-		}
+	const USWeaponDefinition* Definition = GetDefinition();
 
-		PlayFireEffects(TracerEndPoint);
+	const FVector EyeLocation = Shot.EyeLocation;
+
+	// bullet spread from the server's seed and the shot's place in the sequence, so the owner draws the line the server traces
+	FRandomStream SpreadStream((int32)HashCombine((uint32)SpreadSeed.Seed, (uint32)Shot.ShotIndex));
+	float HalfRad = FMath::DegreesToRadians(Definition->BulletSpread);
+	FVector ShotDirection = SpreadStream.VRandCone(Shot.AimDirection, HalfRad, HalfRad);
+
+	FVector TraceEnd = EyeLocation + (ShotDirection * 10000);
+
+	FCollisionQueryParams QueryParams;
+	QueryParams.AddIgnoredActor(MyOwner);
+	QueryParams.AddIgnoredActor(this);
+	QueryParams.bTraceComplex = true;
+	QueryParams.bReturnPhysicalMaterial = true;
+
+	FHitResult Hit;
 
+	// particle "Target" parameter
+	FVector TracerEndPoint = TraceEnd;
 
-		if (GetLocalRole() == ROLE_Authority) {
-			HitScanTrace.TraceTo = TracerEndPoint;
-			HitScanTrace.SurfaceType = SurfaceType;
+	EPhysicalSurface SurfaceType = SurfaceType_Default;
 
-			CurrentAmmoInMag--;
-			CurrentAmmo--;
+	// a listen server host over budget stops drawing other players' shots, their own clients still do
+	const bool bPlayCosmetics = GetLocalRole() < ROLE_Authority || USServerGovernorSubsystem::AreServerCosmeticsAllowed(this) || (MyOwner->GetInstigatorController() && MyOwner->GetInstigatorController()->IsLocalController());
+
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		// character poses are only evaluated at a low rate on the server, bring the ones along this shot up to date
+		GetWorld()->GetSubsystem<USServerAnimationSubsystem>()->EnsurePosesForHitQuery(EyeLocation, TraceEnd);
+	}
+
+	if (GetWorld()->LineTraceSingleByChannel(Hit, EyeLocation, TraceEnd, COLLISION_WEAPON, QueryParams))
+	{
+		// blocking hit! Process damage
+		AActor* HitActor = Hit.GetActor();
+
+		SurfaceType = UPhysicalMaterial::DetermineSurfaceType(Hit.PhysMaterial.Get());
+
+		float ActualDamage = (SurfaceType == SURFACE_FLESHVULNERABLE) ? Definition->BaseDamage * Definition->HeadshotDamageMultiplier : Definition->BaseDamage;
+
+
+		UGameplayStatics::ApplyPointDamage(HitActor, ActualDamage, ShotDirection, Hit, MyOwner->GetInstigatorController(), MyOwner, Definition->DamageType);
+
+		if (bPlayCosmetics)
+		{
+			PlayImpactEffects(SurfaceType, Hit.ImpactPoint);
 		}
 
-		if(Cast<ASCharacter>(MyOwner)->IsLocallyControlled() || GetLocalRole() == ROLE_Authority)
+		TracerEndPoint = Hit.ImpactPoint;
+	}
+
+	if (DebugWeaponDrawing > 0) {
+		DrawDebugLine(GetWorld(), EyeLocation, TraceEnd, FColor::Red, false, 1.0, 0, 1.0f);
+	}
+
+	if (bPlayCosmetics)
+	{
+		PlayFireEffects(TracerEndPoint);
+	}
+
+	if (GetNetMode() == NM_ListenServer)
+	{
+		// the host never gets OnRep_HitScanHistory, its killcam records the shots here
+		if (USKillcamSubsystem* Killcam = GetWorld()->GetSubsystem<USKillcamSubsystem>())
 		{
-			
+			Killcam->RecordShot(MyOwner, TracerEndPoint, SurfaceType);
 		}
+	}
 
-		LastFireTime = GetWorld()->TimeSeconds;
+	if (GetLocalRole() == ROLE_Authority) {
+		// a whole batch fits, so every shot between two net updates reaches the proxies
+		FHitScanTrace& Trace = HitScanHistory.Traces[HitScanHistory.ShotCount % HitScanHistory.Traces.Num()];
+		Trace.TraceTo = TracerEndPoint;
+		Trace.SurfaceType = SurfaceType;
+
+		HitScanHistory.ShotCount++;
+
+		CurrentAmmoInMag--;
+		CurrentAmmo--;
+
+		OnAmmoChanged.Broadcast(this, CurrentAmmoInMag, CurrentAmmo);
 	}
 }
 
-void ASWeapon::ServerFire_Implementation()
+bool ASWeapon::IsServerShotPlausible() const
 {
-	Fire();
+	ASCharacter* MyOwner = Cast<ASCharacter>(GetOwner());
+
+	// dead or unowned weapons don't shoot, and the rest of CanFire is just as cheap
+	return MyOwner && !MyOwner->IsDead() && CanFire();
 }
 
-bool ASWeapon::ServerFire_Validate()
+bool ASWeapon::ValidateClientShot(FSWeaponShot& Shot) const
 {
+	// the cadence is checked on the shots' own timestamps, so batching and frame rate don't matter
+	if (Shot.ShotTime < LastServerShotTime + TimeBetweenShots * 0.9f)
+	{
+		return false;
+	}
+
+	if (Shot.ShotTime > GetWorld()->GetTimeSeconds() + ServerShotTimeTolerance)
+	{
+		return false;
+	}
+
+	FVector ServerEyeLocation;
+	FRotator ServerEyeRotation;
+
+	GetOwner()->GetActorEyesViewPoint(ServerEyeLocation, ServerEyeRotation);
+
+	// the client may only be off by how far it could have moved within its ping
+	float Latency = ServerShotMaxLatency;
+
+	const APawn* MyPawn = Cast<APawn>(GetOwner());
+	if (MyPawn && MyPawn->GetPlayerState())
+	{
+		Latency = FMath::Min(MyPawn->GetPlayerState()->ExactPing * 0.001f, ServerShotMaxLatency);
+	}
+
+	const float EyeTolerance = ServerShotEyeTolerance + GetOwner()->GetVelocity().Size() * Latency;
+
+	// a shot from somewhere the pawn never was still fires, but from where the server has it
+	const FVector EyeOffset = Shot.EyeLocation - ServerEyeLocation;
+	if (EyeOffset.SizeSquared() > FMath::Square(EyeTolerance))
+	{
+		Shot.EyeLocation = ServerEyeLocation + EyeOffset.GetClampedToMaxSize(EyeTolerance);
+	}
+
 	return true;
 }
 
+void ASWeapon::ServerFireBatch_Implementation(const TArray<FSWeaponShot>& Shots)
+{
+	static const FName RpcName(TEXT("ServerFireBatch"));
+
+	// the batch pays once, the shots inside it are held to the cadence by their own timestamps
+	const bool bWithinBudget = FireRateLimit.TryConsume(GetWorld()->GetTimeSeconds());
+
+	for (const FSWeaponShot& ClientShot : Shots)
+	{
+		// shots fired before an equip belong to the old weapon
+		if (ClientShot.SpreadEpoch != SpreadSeed.Epoch)
+		{
+			FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("stale spread seed"));
+			continue;
+		}
+
+		// reused or skipped indices would let a client pick its spread, an honest one never sends them
+		if (ClientShot.ShotIndex != NextShotIndex)
+		{
+			FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("shot out of sequence"));
+			continue;
+		}
+
+		// spent even if the shot is dropped below, the owner already drew it
+		NextShotIndex++;
+
+		if (!bWithinBudget)
+		{
+			FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("over fire rate budget"));
+			continue;
+		}
+
+		if (!IsServerShotPlausible())
+		{
+			FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("implausible shot"));
+			continue;
+		}
+
+		FSWeaponShot Shot = ClientShot;
+
+		if (!ValidateClientShot(Shot))
+		{
+			FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("shot out of cadence"));
+			continue;
+		}
+
+		FSRpcRateLimitStats::RecordAccepted(RpcName);
+
+		LastServerShotTime = Shot.ShotTime;
+
+		FireShot(Shot);
+	}
+}
+
+bool ASWeapon::ServerFireBatch_Validate(const TArray<FSWeaponShot>& Shots)
+{
+	// out of budget shots are dropped in the implementation, only a batch no client ever builds kicks
+	return Shots.Num() <= MaxShotsPerBatch;
+}
+
 void ASWeapon::StartFire()
 {
+	AActor* MyOwner = GetOwner();
 
-	float FirstDelay = FMath::Max(LastFireTime + TimeBetweenShots - GetWorld()->TimeSeconds, 0.0f);
+	if (MyOwner == nullptr)
+	{
+		return;
+	}
+
+	const float Now = GetWorld()->TimeSeconds;
 
-	GetWorldTimerManager().SetTimer(TimerHandle_TimeBetweenShots, this, &ASWeapon::Fire, TimeBetweenShots, true, FirstDelay);
+	// the first shot is due right away unless the last one was too recent
+	NextShotTime = FMath::Max(LastFireTime + TimeBetweenShots, Now);
+
+	FRotator EyeRotation;
+	MyOwner->GetActorEyesViewPoint(LastEyeLocation, EyeRotation);
+	LastEyeRotation = EyeRotation.Quaternion();
+
+	SetActorTickEnabled(true);
 }
 
 void ASWeapon::StopFire()
 {
-	GetWorldTimerManager().ClearTimer(TimerHandle_TimeBetweenShots);
+	SetActorTickEnabled(false);
 }
 
 void ASWeapon::Reload()
@@ -219,20 +664,22 @@ void ASWeapon::Reload()
 	}
 	//function used to replicate this will kick off the animations, now just set the "complete reload" timer for the ammo to be added
 	// the animations will need to be played locally though, as it doesn't repnotify to the owner.
-	bPendingReload = true;
+	SetPendingReload(true);
 
-	GetWorldTimerManager().SetTimer(TimerHandle_ReloadTime, this, &ASWeapon::CompleteReload, ReloadTime, false);
+	GetWorldTimerManager().SetTimer(TimerHandle_ReloadTime, this, &ASWeapon::CompleteReload, GetDefinition()->ReloadTime, false);
 }
 
 void ASWeapon::CompleteReload()
 {
 	//get the amount of ammo we are adding to the magazine
-	int32 ClipDelta = FMath::Min(AmmoPerMag - CurrentAmmoInMag, CurrentAmmo - CurrentAmmoInMag);
+	int32 ClipDelta = FMath::Min(GetDefinition()->AmmoPerMag - CurrentAmmoInMag, CurrentAmmo - CurrentAmmoInMag);
 
 	if(ClipDelta > 0)
 		CurrentAmmoInMag += ClipDelta;
 
-	bPendingReload = false;
+	SetPendingReload(false);
+
+	OnAmmoChanged.Broadcast(this, CurrentAmmoInMag, CurrentAmmo);
 }
 
 void ASWeapon::StartReload()
@@ -247,6 +694,16 @@ void ASWeapon::StopReload()
 
 void ASWeapon::ServerReload_Implementation()
 {
+	static const FName RpcName(TEXT("ServerReload"));
+
+	if (!ReloadRateLimit.TryConsume(GetWorld()->GetTimeSeconds()))
+	{
+		FSRpcRateLimitStats::RecordDropped(this, RpcName, TEXT("over reload budget"));
+		return;
+	}
+
+	FSRpcRateLimitStats::RecordAccepted(RpcName);
+
 	Reload();
 }
 
@@ -257,6 +714,12 @@ bool ASWeapon::ServerReload_Validate()
 
 void ASWeapon::PlayFireEffects(FVector TraceEnd)
 {
+	const USWeaponDefinition* Definition = GetDefinition();
+
+	// soft references, null until the client bundle has streamed in
+	UParticleSystem* MuzzleEffect = Definition->MuzzleEffect.Get();
+	UParticleSystem* TracerEffect = Definition->TracerEffect.Get();
+
 	if (MuzzleEffect)
 	{
 		UGameplayStatics::SpawnEmitterAttached(MuzzleEffect, MeshComp, MuzzleSocketName);
@@ -279,8 +742,8 @@ void ASWeapon::PlayFireEffects(FVector TraceEnd)
 	{
 		APlayerController* PC = Cast<APlayerController>(MyOwner->GetController());
 
-		if (PC) {
-			PC->ClientPlayCameraShake(FireCamShake);
+		if (PC && Definition->FireCamShake.Get()) {
+			PC->ClientPlayCameraShake(Definition->FireCamShake.Get());
 		}
 	}
 }
@@ -293,10 +756,10 @@ void ASWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoi
 	{
 	case SURFACE_FLESHDEFAULT:
 	case SURFACE_FLESHVULNERABLE:
-		SelectedEffect = FleshImpactEffect;
+		SelectedEffect = GetDefinition()->FleshImpactEffect.Get();
 		break;
 	default:
-		SelectedEffect = DefaultImpactEffect;
+		SelectedEffect = GetDefinition()->DefaultImpactEffect.Get();
 		break;
 	}
 
@@ -309,11 +772,36 @@ void ASWeapon::PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoi
 	}
 }
 
+const USWeaponDefinition* ASWeapon::GetDefinition() const
+{
+	if (WeaponDefinition)
+	{
+		return WeaponDefinition;
+	}
+
+	// a Blueprint still on its old tuning, the same on every machine since each one loads the class itself
+	const USWeaponDefinition* ClassLegacyDefinition = GetClass()->GetDefaultObject<ASWeapon>()->LegacyDefinition;
+
+	return ClassLegacyDefinition ? ClassLegacyDefinition : GetDefault<USWeaponDefinition>();
+}
+
+float ASWeapon::GetZoomedFOV() const
+{
+	return GetDefinition()->ZoomedFOV;
+}
+
+float ASWeapon::GetZoomSpeed() const
+{
+	return GetDefinition()->ZoomInterpSpeed;
+}
+
 void ASWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME_CONDITION(ASWeapon, HitScanTrace, COND_SkipOwner);
+	DOREPLIFETIME(ASWeapon, WeaponDefinition);
+	DOREPLIFETIME_CONDITION(ASWeapon, HitScanHistory, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(ASWeapon, SpreadSeed, COND_OwnerOnly);
 	DOREPLIFETIME_CONDITION( ASWeapon, bPendingReload,	COND_SkipOwner );
 	DOREPLIFETIME_CONDITION( ASWeapon, CurrentAmmo,		COND_OwnerOnly );
 	DOREPLIFETIME_CONDITION( ASWeapon, CurrentAmmoInMag, COND_OwnerOnly );
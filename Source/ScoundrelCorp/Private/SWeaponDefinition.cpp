@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SWeaponDefinition.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "Particles/ParticleSystem.h"
+#include "Camera/CameraShake.h"
+#include "Engine/SkeletalMesh.h"
+
+const FName USWeaponDefinition::CosmeticBundleName = TEXT("Client");
+
+const FPrimaryAssetType USWeaponDefinition::PrimaryAssetType = TEXT("WeaponDefinition");
+
+USWeaponDefinition::USWeaponDefinition()
+{
+	BaseDamage = 20.0f;
+	HeadshotDamageMultiplier = 2.0f;
+	RateOfFire = 600;
+	BulletSpread = 2.0f;
+	ZoomedFOV = 65.0f;
+	ZoomInterpSpeed = 20.0f;
+	FireRateLimitBurst = 3.0f;
+
+	// the weapon never started with ammo of its own, each weapon sets its magazines
+	AmmoPerMag = 0;
+	InitialMags = 0;
+	ReloadTime = 1.0f;
+}
+
+FPrimaryAssetId USWeaponDefinition::GetPrimaryAssetId() const
+{
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+TSharedPtr<FStreamableHandle> USWeaponDefinition::LoadCosmetics(const UObject* WorldContextObject) const
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer || !UAssetManager::IsValid())
+	{
+		return nullptr;
+	}
+
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	TSharedPtr<FStreamableHandle> Handle = AssetManager.LoadPrimaryAsset(GetPrimaryAssetId(), { CosmeticBundleName });
+	if (Handle.IsValid())
+	{
+		return Handle;
+	}
+
+	// not registered with the asset manager (or already fully loaded), stream the soft references directly
+	TArray<FSoftObjectPath> CosmeticPaths;
+	for (const FSoftObjectPath& Path : { WeaponMesh.ToSoftObjectPath(), MuzzleEffect.ToSoftObjectPath(), DefaultImpactEffect.ToSoftObjectPath(), FleshImpactEffect.ToSoftObjectPath(), TracerEffect.ToSoftObjectPath(), FireCamShake.ToSoftObjectPath() })
+	{
+		if (Path.IsValid())
+		{
+			CosmeticPaths.Add(Path);
+		}
+	}
+
+	if (CosmeticPaths.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	return AssetManager.GetStreamableManager().RequestAsyncLoad(CosmeticPaths);
+}
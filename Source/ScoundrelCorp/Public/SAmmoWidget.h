@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SHUDWidget.h"
+#include "SAmmoWidget.generated.h"
+
+class UTextBlock;
+class UWidget;
+
+/**
+ * Magazine and reserve ammo of the current weapon, text is only rebuilt when a count actually changes.
+ */
+UCLASS(Abstract)
+class SCOUNDRELCORP_API USAmmoWidget : public USHUDWidget
+{
+	GENERATED_BODY()
+
+public:
+	USAmmoWidget(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	virtual void OnObservedWeaponChanged(ASWeapon* OldWeapon, ASWeapon* NewWeapon) override;
+
+	UFUNCTION()
+	void HandleAmmoChanged(ASWeapon* Weapon, int32 AmmoInMag, int32 TotalAmmo);
+
+	UFUNCTION()
+	void HandleReloadStateChanged(ASWeapon* Weapon, bool bReloading);
+
+	void UpdateAmmo(int32 AmmoInMag, int32 TotalAmmo);
+
+	void UpdateReloading(bool bReloading);
+
+	UPROPERTY(meta = (BindWidget))
+	UTextBlock* AmmoInMagText;
+
+	/* Rounds left outside the magazine */
+	UPROPERTY(meta = (BindWidget))
+	UTextBlock* ReserveAmmoText;
+
+	/* Shown while reloading */
+	UPROPERTY(meta = (BindWidgetOptional))
+	UWidget* ReloadingIndicator;
+
+	int32 DisplayedAmmoInMag;
+
+	int32 DisplayedReserveAmmo;
+};
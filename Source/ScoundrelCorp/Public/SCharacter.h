@@ -12,6 +12,11 @@ class USpringArmComponent;
 class UInputComponent;
 class ASWeapon;
 class USHealthComponent;
+class USAbilityComponent;
+class USInventoryComponent;
+class USCharacterMovementComponent;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCurrentWeaponChangedSignature, ASCharacter*, Character, ASWeapon*, Weapon);
 
 UCLASS()
 class SCOUNDRELCORP_API ASCharacter : public ACharacter
@@ -20,12 +25,23 @@ class SCOUNDRELCORP_API ASCharacter : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	ASCharacter();
+	ASCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void PossessedBy(AController* NewController) override;
+
+	virtual void UnPossessed() override;
+
+	/* Clients (and a listen server host) get the torn off pawn as their local corpse */
+	virtual void TornOff() override;
+
+	void StartRagdoll();
+
 	void MoveForward(float value);
 
 	void MoveRight(float value);
@@ -34,6 +50,19 @@ protected:
 
 	void EndCrouch();
 
+	void BeginSprint();
+
+	void EndSprint();
+
+	void Dodge();
+
+	void NextWeapon();
+
+	void PreviousWeapon();
+
+	UFUNCTION()
+	void OnActiveWeaponChanged(USInventoryComponent* OwningInventoryComp, int32 ActiveIndex);
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	UCameraComponent* CameraComp;
 
@@ -43,6 +72,12 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USHealthComponent* HealthComp;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USAbilityComponent* AbilityComp;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USInventoryComponent* InventoryComp;
+
 	bool bWantsToZoom;	
 
 	/* Default FOV set during begin play*/
@@ -52,9 +87,12 @@ protected:
 
 	void Unzoom();
 
-	UPROPERTY(Replicated)
+	UPROPERTY(ReplicatedUsing=OnRep_CurrentWeapon)
 	ASWeapon* CurrentWeapon;
 
+	UFUNCTION()
+	void OnRep_CurrentWeapon();
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Player")
 	TSubclassOf<ASWeapon> StarterWeaponClass;
 
@@ -70,27 +108,35 @@ protected:
 	UPROPERTY(Replicated, BlueprintReadOnly, Category="Player")
 	bool bDied;
 
+	/* How long a dedicated server keeps the dead pawn around, just long enough for the tear off to reach everyone */
+	UPROPERTY(EditDefaultsOnly, Category = "Player", meta = (ClampMin = 0.1f))
+	float ServerCorpseLifeSpan;
+
 	void HandleZoom(float DeltaTime);
 
-	// abilities
-	UPROPERTY(EditDefaultsOnly, Category = "Player")
-	float AbilityCooldown;
+	/* Zooming is done, stop ticking unless a Blueprint implements Event Tick */
+	void StopZoomTick();
+
+	/* Set in BeginPlay, Blueprint children with Event Tick keep ticking every frame */
+	uint8 bBlueprintTicks : 1;
 
-	UPROPERTY(Transient, ReplicatedUsing=OnRep_Ability)
-	uint32 bPendingAbility : 1;
+	// abilities
+	/* Ability in the AbilityComp fired by the "Ability" input */
+	UPROPERTY(EditDefaultsOnly, Category = "Player/Ability")
+	FName PrimaryAbilityName;
 
 	UFUNCTION()
-    void OnRep_Ability();
+	void OnAbilityActivated(USAbilityComponent* OwningAbilityComp, FName AbilityName);
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Player/Ability")
 		void PerformAbility();
-	
-	FTimerHandle TimerHandle_AbilityTime;
-	
-	float lastAbilityTime;
+
+	/* Cosmetic only, the roll itself is done by the movement component */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Player/Ability")
+		void PlayDodgeRoll();
 	
 public:	
-	// Called every frame
+	// Only enabled while the zoom is interpolating
 	virtual void Tick(float DeltaTime) override;
 
 	// Called to bind functionality to input
@@ -98,6 +144,18 @@ public:
 
 	virtual FVector GetPawnViewLocation() const override;
 
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Player")
+	USCharacterMovementComponent* GetSCharacterMovement() const;
+
+	bool IsDead() const { return bDied; }
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Player")
+	ASWeapon* GetCurrentWeapon() const { return CurrentWeapon; }
+
+	/* Fired once the weapon actor exists here, it can replicate after the pawn */
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnCurrentWeaponChangedSignature OnCurrentWeaponChanged;
+
 	// start and stop fire must be public so we can call it from Behavior Trees for the AI to use them.
 	UFUNCTION(BlueprintCallable, Category = "Player")
         void StartFire();
@@ -112,10 +170,6 @@ public:
 
 	UFUNCTION(BlueprintCallable, Category = "Player")
 		void StartAbility();
-	UFUNCTION(Server, Reliable, WithValidation)
-		void ServerStartAbility();
-
-	void CompleteAbility();
 
 	
 };
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SCorpseSubsystem.generated.h"
+
+class ACharacter;
+
+/**
+ * Client side budget for ragdolls.
+ * Dead characters are torn off by the server and only live on as local ragdolls, this keeps at most SC.MaxCorpses of them
+ * around and recycles the oldest one first, so physics cost stays flat however long the match runs.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USCorpseSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Takes ownership of the corpse's lifetime, may destroy older corpses to make room */
+	void RegisterCorpse(ACharacter* Corpse);
+
+	int32 GetNumCorpses() const { return Corpses.Num(); }
+
+protected:
+
+	/* Oldest first */
+	TArray<TWeakObjectPtr<ACharacter>> Corpses;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SHUDWidget.h"
+#include "SCrosshairWidget.generated.h"
+
+/**
+ * Crosshair that fades while the current weapon reloads, and only repaints when it starts or stops.
+ */
+UCLASS(Abstract)
+class SCOUNDRELCORP_API USCrosshairWidget : public USHUDWidget
+{
+	GENERATED_BODY()
+
+public:
+	USCrosshairWidget(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	virtual void OnObservedPawnChanged(APawn* OldPawn, APawn* NewPawn) override;
+
+	virtual void OnObservedWeaponChanged(ASWeapon* OldWeapon, ASWeapon* NewWeapon) override;
+
+	UFUNCTION()
+	void HandleReloadStateChanged(ASWeapon* Weapon, bool bReloading);
+
+	void UpdateCrosshair(bool bHasWeapon, bool bReloading);
+
+	/* Render opacity of the crosshair while the weapon reloads */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD", meta = (ClampMin = 0.0f, ClampMax = 1.0f))
+	float ReloadingOpacity;
+};
@@ -20,10 +20,46 @@ public:
 
 	virtual void StartPlay() override;
 
-	virtual void Tick(float DeltaSeconds) override;
-
 	UPROPERTY(BlueprintAssignable, Category = "GameMode")
 		FOnActorKilled OnActorKilled;
 
-	void RestartDeadPlayer(APlayerController* PC);
+	/* Respawns at the start the spawn selection rates safest for the player's team, after RespawnDelay */
+	void RestartDeadPlayer(APlayerController* PC, uint8 TeamNum);
+
+protected:
+
+	/* Seconds between dying and respawning, long enough for the killcam to play */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "GameMode", meta = (ClampMin = 0.0f))
+	float RespawnDelay;
+
+	void RestartDeadPlayerNow(TWeakObjectPtr<APlayerController> PC, uint8 TeamNum);
+
+	/* Maps played in order, the match after the last one goes back to the first */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "GameMode|Rotation", meta = (AllowedClasses = "World"))
+	TArray<FSoftObjectPath> MapRotation;
+
+	/* Seconds a match lasts before we travel to the next map, 0 never ends it */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "GameMode|Rotation", meta = (ClampMin = 0.0f))
+	float MatchDuration;
+
+	/* How long before the end of the match everyone starts loading the next map in the background */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "GameMode|Rotation", meta = (ClampMin = 0.0f))
+	float PreloadLeadTime;
+
+	/* Longest the end of the match waits on the server's own preload of the next map before travelling anyway */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "GameMode|Rotation", meta = (ClampMin = 0.0f))
+	float MaxPreloadWait;
+
+	/* How long EndMatch has been held back for the preload so far */
+	float PreloadWaitTime;
+
+	FTimerHandle TimerHandle_PreloadNextMap;
+
+	FTimerHandle TimerHandle_EndMatch;
+
+	FSoftObjectPath GetNextMap() const;
+
+	void PreloadNextMap();
+
+	void EndMatch();
 };
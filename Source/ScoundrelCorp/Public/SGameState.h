@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameStateBase.h"
+#include "Engine/NetSerialization.h"
+#include "SGameState.generated.h"
+
+class APlayerState;
+class ASGameState;
+struct FSScoreboard;
+struct FSKillFeed;
+
+// Match stats of one player. Only the entries that changed are sent.
+USTRUCT(BlueprintType)
+struct FSScoreboardEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	APlayerState* PlayerState;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 Kills;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	int32 Deaths;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Scoreboard")
+	float Damage;
+
+	FSScoreboardEntry()
+		: PlayerState(nullptr)
+		, Kills(0)
+		, Deaths(0)
+		, Damage(0.0f)
+	{}
+
+	// client side callbacks, see FFastArraySerializer
+	void PreReplicatedRemove(const FSScoreboard& InArraySerializer);
+	void PostReplicatedAdd(const FSScoreboard& InArraySerializer);
+	void PostReplicatedChange(const FSScoreboard& InArraySerializer);
+};
+
+USTRUCT()
+struct FSScoreboard : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	TArray<FSScoreboardEntry> Items;
+
+	UPROPERTY(NotReplicated)
+	ASGameState* Owner;
+
+	FSScoreboard()
+		: Owner(nullptr)
+	{}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSScoreboardEntry, FSScoreboard>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSScoreboard> : public TStructOpsTypeTraitsBase2<FSScoreboard>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+// One line of the kill feed. Never changes once added, old lines are dropped off the front.
+USTRUCT(BlueprintType)
+struct FSKillFeedEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "KillFeed")
+	APlayerState* Victim;
+
+	/* Null for suicides and kills by anything without a player state */
+	UPROPERTY(BlueprintReadOnly, Category = "KillFeed")
+	APlayerState* Killer;
+
+	UPROPERTY(BlueprintReadOnly, Category = "KillFeed")
+	float ServerTime;
+
+	FSKillFeedEntry()
+		: Victim(nullptr)
+		, Killer(nullptr)
+		, ServerTime(0.0f)
+	{}
+
+	void PostReplicatedAdd(const FSKillFeed& InArraySerializer);
+};
+
+USTRUCT()
+struct FSKillFeed : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	TArray<FSKillFeedEntry> Items;
+
+	UPROPERTY(NotReplicated)
+	ASGameState* Owner;
+
+	FSKillFeed()
+		: Owner(nullptr)
+	{}
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FSKillFeedEntry, FSKillFeed>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FSKillFeed> : public TStructOpsTypeTraitsBase2<FSKillFeed>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScoreboardEntryChangedSignature, ASGameState*, GameState, const FSScoreboardEntry&, Entry);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnScoreboardEntryRemovedSignature, ASGameState*, GameState, APlayerState*, PlayerState);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnKillFeedEntryAddedSignature, ASGameState*, GameState, const FSKillFeedEntry&, Entry);
+
+/**
+ * Replicated match state: scoreboard and kill feed.
+ * Both are fast arrays, so a kill or a hit only sends the entries it touched,
+ * and clients get per entry callbacks to update the UI incrementally.
+ */
+UCLASS()
+class SCOUNDRELCORP_API ASGameState : public AGameStateBase
+{
+	GENERATED_BODY()
+
+public:
+	ASGameState();
+
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+
+	/* Server only. Credits damage dealt to another actor to the instigator's stats. */
+	void RecordDamage(AController* InstigatedBy, AActor* DamagedActor, float Damage);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Scoreboard")
+	const TArray<FSScoreboardEntry>& GetScoreboard() const { return Scoreboard.Items; }
+
+	/* Oldest first */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "KillFeed")
+	const TArray<FSKillFeedEntry>& GetKillFeed() const { return KillFeed.Items; }
+
+	/* Fired for added and changed entries, on the server as well as on clients */
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnScoreboardEntryChangedSignature OnScoreboardEntryChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnScoreboardEntryRemovedSignature OnScoreboardEntryRemoved;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnKillFeedEntryAddedSignature OnKillFeedEntryAdded;
+
+	/* Server only. Announces the next map of the rotation so everyone starts preloading it. */
+	void SetNextMap(const FSoftObjectPath& InNextMap, float InMatchEndTime);
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Match")
+	float GetMatchEndTime() const { return MatchEndTime; }
+
+protected:
+
+	virtual void BeginPlay() override;
+
+	UFUNCTION()
+	void HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController);
+
+	/* Adds an entry on first use, returns null for anything that isn't a player */
+	FSScoreboardEntry* FindOrAddEntry(APlayerState* PlayerState);
+
+	void MarkEntryChanged(FSScoreboardEntry& Entry);
+
+	static APlayerState* GetPlayerStateOf(AActor* Actor, AController* Controller);
+
+	UPROPERTY(Replicated)
+	FSScoreboard Scoreboard;
+
+	UPROPERTY(Replicated)
+	FSKillFeed KillFeed;
+
+	UPROPERTY(ReplicatedUsing=OnRep_NextMap, BlueprintReadOnly, Category = "Match")
+	FSoftObjectPath NextMap;
+
+	UFUNCTION()
+	void OnRep_NextMap();
+
+	/* Server world time the match ends and we travel to NextMap at, 0 while it isn't known yet */
+	UPROPERTY(Replicated)
+	float MatchEndTime;
+
+	/* Lines kept in the kill feed, the oldest is dropped when a new one comes in */
+	UPROPERTY(EditDefaultsOnly, Category = "KillFeed", meta = (ClampMin = 1))
+	int32 MaxKillFeedEntries;
+};
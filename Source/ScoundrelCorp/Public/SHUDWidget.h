@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "SHUDWidget.generated.h"
+
+class ASCharacter;
+class ASPlayerController;
+class ASWeapon;
+
+/**
+ * Base for HUD widgets that follow the owning player's pawn and weapon through events instead of property bindings.
+ * Nothing here ticks; wrap the widget's root in an Invalidation Box so an unchanged HUD isn't laid out or painted again.
+ */
+UCLASS(Abstract, meta = (DisableNativeTick))
+class SCOUNDRELCORP_API USHUDWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void NativeConstruct() override;
+
+	virtual void NativeDestruct() override;
+
+	/* Old pawn first so subclasses can unbind from it */
+	virtual void OnObservedPawnChanged(APawn* OldPawn, APawn* NewPawn) {}
+
+	virtual void OnObservedWeaponChanged(ASWeapon* OldWeapon, ASWeapon* NewWeapon) {}
+
+	UFUNCTION()
+	void HandlePawnChanged(ASPlayerController* PlayerController, APawn* NewPawn);
+
+	UFUNCTION()
+	void HandleCurrentWeaponChanged(ASCharacter* Character, ASWeapon* NewWeapon);
+
+	void SetObservedPawn(APawn* NewPawn);
+
+	void SetObservedWeapon(ASWeapon* NewWeapon);
+
+	TWeakObjectPtr<APawn> ObservedPawn;
+
+	TWeakObjectPtr<ASWeapon> ObservedWeapon;
+};
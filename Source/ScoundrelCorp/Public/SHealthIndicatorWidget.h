@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SHUDWidget.h"
+#include "SHealthIndicatorWidget.generated.h"
+
+class UImage;
+class UMaterialInstanceDynamic;
+class USHealthComponent;
+
+/**
+ * Drives the health indicator material from OnHealthChanged, only touching it when the displayed fraction changes.
+ */
+UCLASS(Abstract)
+class SCOUNDRELCORP_API USHealthIndicatorWidget : public USHUDWidget
+{
+	GENERATED_BODY()
+
+public:
+	USHealthIndicatorWidget(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	virtual void NativeOnInitialized() override;
+
+	virtual void OnObservedPawnChanged(APawn* OldPawn, APawn* NewPawn) override;
+
+	UFUNCTION()
+	void HandleHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
+	void UpdateHealth(const USHealthComponent* HealthComp);
+
+	/* Image using the health indicator material */
+	UPROPERTY(meta = (BindWidget))
+	UImage* HealthImage;
+
+	/* Scalar parameter on HealthImage's material set to the remaining health, 0 to 1 */
+	UPROPERTY(EditDefaultsOnly, Category = "HUD")
+	FName HealthParameterName;
+
+	UPROPERTY(Transient)
+	UMaterialInstanceDynamic* HealthMaterial;
+
+	float DisplayedHealthFraction;
+};
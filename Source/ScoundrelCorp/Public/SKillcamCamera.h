@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "SKillcamSubsystem.h"
+#include "SKillcamCamera.generated.h"
+
+class UCameraComponent;
+
+/**
+ * Local only camera that replays the killer's view from the killcam buffer.
+ * Shots and health changes are handed to blueprint so FX and UI can be played without touching the live actors.
+ */
+UCLASS()
+class SCOUNDRELCORP_API ASKillcamCamera : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ASKillcamCamera();
+
+	/* Takes over the local player's view until the clip ends or they get a new pawn */
+	void StartPlayback(APlayerController* PC, const TArray<FSKillcamViewSample>& InViewSamples, const TArray<FSKillcamShot>& InShots, const TArray<FSKillcamHealthChange>& InHealthChanges);
+
+	void StopPlayback();
+
+	virtual void Tick(float DeltaTime) override;
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	UCameraComponent* CameraComp;
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Killcam")
+	void OnReplayShot(FVector TraceStart, FVector TraceTo, EPhysicalSurface SurfaceType);
+
+	/* Health of the local player's pawn as it was at that point of the clip */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Killcam")
+	void OnReplayHealthChanged(float Health);
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Killcam")
+	void OnPlaybackFinished();
+
+	UPROPERTY(Transient)
+	APlayerController* ViewingPC;
+
+	TArray<FSKillcamViewSample> ViewSamples;
+
+	TArray<FSKillcamShot> Shots;
+
+	TArray<FSKillcamHealthChange> HealthChanges;
+
+	float PlaybackTime;
+
+	int32 NextShot;
+
+	int32 NextHealthChange;
+};
@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Engine/EngineTypes.h"
+#include "SKillcamSubsystem.generated.h"
+
+class ASCharacter;
+class ASGameState;
+class ASKillcamCamera;
+class APlayerState;
+class USHealthComponent;
+struct FSKillFeedEntry;
+
+// Decompressed state handed to the killcam camera for playback.
+USTRUCT(BlueprintType)
+struct FSKillcamViewSample
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Seconds from the start of the clip */
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	float Time;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	FVector Location;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	FRotator Rotation;
+
+	FSKillcamViewSample()
+		: Time(0.0f)
+		, Location(ForceInitToZero)
+		, Rotation(ForceInitToZero)
+	{}
+};
+
+USTRUCT(BlueprintType)
+struct FSKillcamShot
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	float Time;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	FVector TraceTo;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	TEnumAsByte<EPhysicalSurface> SurfaceType;
+
+	FSKillcamShot()
+		: Time(0.0f)
+		, TraceTo(ForceInitToZero)
+		, SurfaceType(SurfaceType_Default)
+	{}
+};
+
+USTRUCT(BlueprintType)
+struct FSKillcamHealthChange
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	float Time;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Killcam")
+	float Health;
+
+	FSKillcamHealthChange()
+		: Time(0.0f)
+		, Health(0.0f)
+	{}
+};
+
+/**
+ * Client side killcam.
+ * Keeps a short rolling buffer of replicated state we receive anyway (character transforms, shots, health), quantized to keep it small,
+ * and plays it back from the killer's point of view when the kill feed reports the local player's death. Nothing extra is sent or simulated by the server.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USKillcamSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USKillcamSubsystem();
+
+	/* Does nothing on dedicated servers */
+	void RegisterCharacter(ASCharacter* Character);
+
+	/* Called for every shot of another player we draw, and on a listen server host for every shot fired */
+	void RecordShot(const AActor* Shooter, const FVector& TraceTo, EPhysicalSurface SurfaceType);
+
+	void RecordHealth(const AActor* Owner, float Health);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	// 4cm steps relative to the frame origin, covers about 1.3 km each way from the frame centre
+	struct FPackedSample
+	{
+		uint16 Slot;
+
+		int16 X, Y, Z;
+
+		uint16 Pitch, Yaw;
+	};
+
+	struct FFrame
+	{
+		float Time;
+
+		FVector Origin;
+
+		TArray<FPackedSample> Samples;
+	};
+
+	struct FShotEvent
+	{
+		float Time;
+
+		uint16 Slot;
+
+		FVector_NetQuantize TraceTo;
+
+		uint8 SurfaceType;
+	};
+
+	struct FHealthEvent
+	{
+		float Time;
+
+		uint16 Slot;
+
+		int16 Health;
+	};
+
+	/* Slot of a character in the packed data, registers it on first sight */
+	uint16 GetSlot(const AActor* Actor);
+
+	/* Slots of destroyed characters are handed out again once they have left the buffer window */
+	void ReleaseSlot(uint16 Slot);
+
+	/* Remembers which slot a player's pawn used, the pawn may be gone by the time the kill feed names the player */
+	void RememberPlayerSlot(const AActor* Actor, uint16 Slot);
+
+	UFUNCTION()
+	void OnHealthChanged(USHealthComponent* OwningHealthComp, float Health, float HealthDelta, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser);
+
+	void RecordFrame();
+
+	void TrimEvents();
+
+	void BindToGameState();
+
+	UFUNCTION()
+	void OnKillFeedEntryAdded(ASGameState* GameState, const FSKillFeedEntry& Entry);
+
+	void StartKillcam(uint16 KillerSlot);
+
+	TMap<TWeakObjectPtr<const AActor>, uint16> Slots;
+
+	uint16 NextSlot;
+
+	struct FReleasedSlot
+	{
+		uint16 Slot;
+
+		float ReleaseTime;
+	};
+
+	/* Oldest release first */
+	TArray<FReleasedSlot> ReleasedSlots;
+
+	TMap<TWeakObjectPtr<const APlayerState>, uint16> PlayerSlots;
+
+	/* Slot of the local player's last pawn, it is usually gone by the time we learn it died */
+	int32 LocalPawnSlot;
+
+	/* Ring buffer, frames are reused once it's full */
+	TArray<FFrame> Frames;
+
+	int32 NextFrameIndex;
+
+	TArray<FShotEvent> Shots;
+
+	TArray<FHealthEvent> HealthEvents;
+
+	float TimeSinceFrame;
+
+	TWeakObjectPtr<ASGameState> BoundGameState;
+
+	UPROPERTY()
+	ASKillcamCamera* KillcamCamera;
+};
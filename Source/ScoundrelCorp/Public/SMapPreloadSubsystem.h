@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "SMapPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Loads the next map of the rotation and the assets its match needs in the background, on the server and on every client.
+ * Lives on the game instance so what it loaded survives the seamless travel, and lets go of it once the new map is up.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USMapPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	/* Starts loading the map package, its game mode and pawn, and the weapon definitions (with their cosmetics outside of dedicated servers) */
+	void PreloadMap(const FSoftObjectPath& MapPath);
+
+	/* True while MapPath is still loading, false once it is in or if its load failed */
+	bool IsPreloadPending(const FSoftObjectPath& MapPath) const;
+
+protected:
+
+	void OnMapPackageLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	/* Holds on to the game mode and pawn class the next map will spawn players with */
+	void PreloadPawnClasses(UWorld* MapWorld);
+
+	void ReleasePreloads();
+
+	FSoftObjectPath PreloadingMap;
+
+	/* Keeps the loaded map, its level and actors from being garbage collected until we travel. The package alone wouldn't. */
+	UPROPERTY(Transient)
+	UWorld* PreloadedWorld;
+
+	bool bMapLoadFailed;
+
+	/* The next map's game mode and default pawn, kept out of garbage collection through the transition map */
+	UPROPERTY(Transient)
+	TArray<UClass*> PreloadedClasses;
+
+	TSharedPtr<FStreamableHandle> AssetsHandle;
+
+	FDelegateHandle PostLoadMapHandle;
+};
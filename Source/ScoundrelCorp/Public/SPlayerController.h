@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "SPlayerController.generated.h"
+
+class USClockSyncComponent;
+class ASPlayerController;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPawnChangedSignature, ASPlayerController*, PlayerController, APawn*, NewPawn);
+
+/**
+ * 
+ */
+UCLASS()
+class SCOUNDRELCORP_API ASPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	ASPlayerController();
+
+	/* Covers possession on the server and the listen server host */
+	virtual void SetPawn(APawn* InPawn) override;
+
+	/* Remote clients write the replicated pawn before SetPawn runs, so they are notified from here */
+	virtual void OnRep_Pawn() override;
+
+	/* Seamless travel keeps this controller but restarts the world clocks, the clock sync has to start over */
+	virtual void NotifyLoadedWorld(FName WorldPackageName, bool bFinalDest) override;
+
+	/* Fired whenever the controlled pawn changes, including to null on death */
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnPawnChangedSignature OnPawnChanged;
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Player")
+	USClockSyncComponent* GetClockSync() const { return ClockSyncComp; }
+
+protected:
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
+	USClockSyncComponent* ClockSyncComp;
+
+	/* The pawn OnPawnChanged was last fired for, the engine's own Pawn can't tell us what it was before a replicated change */
+	TWeakObjectPtr<APawn> LastNotifiedPawn;
+
+	void NotifyPawnChanged();
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerState.h"
+#include "SPlayerState.generated.h"
+
+/**
+ * Carries a player's totals over the whole session, the per match numbers live in the game state's scoreboard.
+ * Copied to the new player state when the match rotation seamless travels to the next map.
+ */
+UCLASS()
+class SCOUNDRELCORP_API ASPlayerState : public APlayerState
+{
+	GENERATED_BODY()
+
+public:
+	ASPlayerState();
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "PlayerState")
+	int32 TotalKills;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "PlayerState")
+	int32 TotalDeaths;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category = "PlayerState")
+	float TotalDamage;
+
+protected:
+
+	virtual void CopyProperties(APlayerState* PlayerState) override;
+};
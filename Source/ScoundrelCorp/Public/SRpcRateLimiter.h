@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+/**
+ * Token bucket used to cap how often a client may call a server RPC.
+ * Each bucket lives on an actor owned by a single connection, so it is a per-connection limit.
+ */
+struct SCOUNDRELCORP_API FSRpcTokenBucket
+{
+public:
+	FSRpcTokenBucket();
+
+	/* TokensPerSecond is the sustained rate, Burst how many calls may arrive back to back (network jitter bunches RPCs up).
+	   Starts full the first time; reconfiguring keeps the tokens left so it can't be used to refill the bucket. */
+	void Configure(float InTokensPerSecond, float InBurst);
+
+	/* Returns false if the call is over budget and should be dropped */
+	bool TryConsume(float Now);
+
+private:
+	float TokensPerSecond;
+
+	float MaxTokens;
+
+	float Tokens;
+
+	float LastRefillTime;
+
+	bool bConfigured;
+};
+
+/**
+ * Process wide counters for rate limited RPCs, so abuse can be alerted on.
+ * Dump them with SC.RpcLimiter.Report.
+ */
+class SCOUNDRELCORP_API FSRpcRateLimitStats
+{
+public:
+	static void RecordAccepted(FName RpcName);
+
+	/* Logs a warning every WarnEvery drops from the same connection */
+	static void RecordDropped(const AActor* Actor, FName RpcName, const TCHAR* Reason);
+
+	static void Report();
+};
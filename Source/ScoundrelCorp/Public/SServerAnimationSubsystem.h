@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SServerAnimationSubsystem.generated.h"
+
+class USkeletalMeshComponent;
+
+/**
+ * Dedicated server animation policy.
+ * The server only needs bone transforms to resolve hits, so character meshes are evaluated at a low fixed rate
+ * and refreshed on demand when a weapon trace passes near them. Weapon meshes never evaluate a pose.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USServerAnimationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USServerAnimationSubsystem();
+
+	/* Puts a character mesh on the server budget, does nothing outside of dedicated servers */
+	void RegisterCharacterMesh(USkeletalMeshComponent* Mesh);
+
+	void UnregisterCharacterMesh(USkeletalMeshComponent* Mesh);
+
+	/* Weapons only need the MuzzleSocket transform, which the reference pose already gives us */
+	static void ApplyWeaponMeshPolicy(USkeletalMeshComponent* Mesh);
+
+	/* Brings every budgeted mesh near the segment up to date so the trace hits the current pose */
+	void EnsurePosesForHitQuery(const FVector& TraceStart, const FVector& TraceEnd);
+
+	/* Scales the fixed server animation rate, used to shed load */
+	void SetAnimRateScale(float NewScale);
+
+	float GetAnimRateScale() const { return AnimRateScale; }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	void ApplyTickInterval(USkeletalMeshComponent* Mesh) const;
+
+	UPROPERTY()
+	TArray<USkeletalMeshComponent*> BudgetedMeshes;
+
+	float AnimRateScale;
+
+	/* Running average of what a single pose evaluation costs, measured from the forced refreshes */
+	double AverageEvalSeconds;
+
+	int32 ForcedRefreshesThisFrame;
+};
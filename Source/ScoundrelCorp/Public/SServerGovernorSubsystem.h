@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SServerGovernorSubsystem.generated.h"
+
+// Load shedding steps, each level keeps everything the levels below it shed.
+UENUM(BlueprintType)
+enum class ESServerLoadLevel : uint8
+{
+	Normal,
+	ReducedNetRate,
+	ReducedAIRate,
+	ReducedAnimRate,
+	NoCosmetics
+};
+
+/**
+ * Watches the server's game thread frame time and sheds simulation quality when the p95 goes over budget:
+ * net update rates first, then AI think rate, server animation rate and finally cosmetic work on a listen server host.
+ * Levels come back one at a time once the server has been comfortably under budget for a while.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USServerGovernorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USServerGovernorSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	ESServerLoadLevel GetLoadLevel() const { return LoadLevel; }
+
+	/* False while a listen server host is shedding the FX of other players' shots */
+	static bool AreServerCosmeticsAllowed(const UObject* WorldContextObject);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	bool IsServerWorld() const;
+
+	float ComputeFrameTimePercentile(float Percentile) const;
+
+	void SetLoadLevel(ESServerLoadLevel NewLevel, float FrameTimeP95);
+
+	/* Brings a single actor in line with the current level, also used for everything spawned later */
+	void ApplyToActor(AActor* Actor) const;
+
+	void ApplyToAllActors() const;
+
+	void OnActorSpawned(AActor* Actor);
+
+	ESServerLoadLevel LoadLevel;
+
+	/* Game thread time of the last frames in ms, used as a ring buffer */
+	TArray<float> FrameTimeSamples;
+
+	int32 NextSampleIndex;
+
+	float TimeSinceEvaluation;
+
+	/* How long the frame time has been over budget / comfortably under it */
+	float TimeOverBudget;
+
+	float TimeUnderBudget;
+
+	FDelegateHandle ActorSpawnedHandle;
+};
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SSignificanceSubsystem.generated.h"
+
+class ASCharacter;
+
+UENUM(BlueprintType)
+enum class ESSignificance : uint8
+{
+	Culled,
+	Low,
+	Medium,
+	High
+};
+
+/**
+ * Client side scoring of remote characters by distance, view angle and occlusion.
+ * Low significance characters tick and animate slower and get simplified or no fire FX,
+ * so client frame time stays flat as the lobby grows.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USSignificanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USSignificanceSubsystem();
+
+	/* Does nothing on dedicated and listen servers, only clients throttle */
+	void RegisterCharacter(ASCharacter* Character);
+
+	void UnregisterCharacter(ASCharacter* Character);
+
+	/* High for anything that isn't registered, so the server and the local player are never throttled */
+	ESSignificance GetSignificance(const AActor* Actor) const;
+
+	/* Helper for cosmetic code that only has a world context */
+	static ESSignificance GetSignificanceFor(const AActor* Actor);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	void UpdateSignificance();
+
+	ESSignificance ScoreCharacter(const ASCharacter* Character, const FVector& ViewLocation, const FVector& ViewDirection) const;
+
+	void ApplySignificance(ASCharacter* Character, ESSignificance Significance) const;
+
+	TMap<TWeakObjectPtr<ASCharacter>, ESSignificance> Characters;
+
+	float TimeSinceUpdate;
+};
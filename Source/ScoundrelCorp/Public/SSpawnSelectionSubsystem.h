@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "SSpawnSelectionSubsystem.generated.h"
+
+class APlayerStart;
+class AController;
+
+/**
+ * Server side respawn point selection.
+ * Every player start is scored per team in parallel from the distance to hostiles, how many hostiles can see it and how many
+ * people died near it lately. Sight lines are traced a few starts at a time in one async batch per frame and scores are
+ * cached, so picking a start when half the lobby dies at once is just a lookup.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USSpawnSelectionSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USSpawnSelectionSubsystem();
+
+	/* Best cached start for someone on the given team, null if the map has none */
+	APlayerStart* ChoosePlayerStart(uint8 TeamNum);
+
+	/* Bound to ASGameMode::OnActorKilled, deaths make the starts around them less attractive for a while */
+	UFUNCTION()
+	void HandleActorKilled(AActor* VictimActor, AActor* KillerActor, AController* KillerController);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	struct FSpawnCandidate
+	{
+		TWeakObjectPtr<APlayerStart> PlayerStart;
+
+		FVector Location;
+
+		/* Teams of the characters with a clear line of sight to this start, one per character */
+		TArray<uint8> SeenByTeams;
+
+		float Heat;
+
+		TArray<FTraceHandle> PendingTraces;
+
+		TArray<uint8> PendingTraceTeams;
+	};
+
+	void GatherCandidates();
+
+	void ResolveSightTraces(FSpawnCandidate& Candidate) const;
+
+	void IssueSightTraces(FSpawnCandidate& Candidate, const TArray<FVector>& Locations, const TArray<uint8>& Teams) const;
+
+	/* Scores every candidate for every team we know of, in parallel */
+	void RefreshScores(const TArray<FVector>& Locations, const TArray<uint8>& Teams);
+
+	float ScoreCandidate(const FSpawnCandidate& Candidate, uint8 TeamNum, const TArray<FVector>& Locations, const TArray<uint8>& Teams) const;
+
+	TArray<FSpawnCandidate> Candidates;
+
+	/* Score of each candidate (same index) per team */
+	TMap<uint8, TArray<float>> CachedScores;
+
+	bool bGatheredCandidates;
+
+	/* Round robin position of the sight line refresh */
+	int32 NextCandidateIndex;
+
+	float TimeSinceScoring;
+};
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "SStatusEffectSubsystem.generated.h"
+
+class USHealthComponent;
+class UDamageType;
+class AController;
+
+/**
+ * Server side heals and damage over time.
+ * Every active effect lives in flat arrays and all of them are applied in one pass at a fixed rate; the net change of each actor
+ * is merged first, so an actor that is burning and being healed gets a single OnHealthChanged and a single Health update per step.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USStatusEffectSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USStatusEffectSubsystem();
+
+	/* Server only. Heals (positive rate) or damages (negative rate) the target's health component every step for the duration. */
+	UFUNCTION(BlueprintCallable, Category = "StatusEffects")
+	void ApplyEffect(AActor* Target, float HealthPerSecond, float Duration, TSubclassOf<UDamageType> DamageType, AController* InstigatedBy, AActor* DamageCauser);
+
+	UFUNCTION(BlueprintCallable, Category = "StatusEffects")
+	void ClearEffects(AActor* Target);
+
+	int32 GetNumActiveEffects() const { return Targets.Num(); }
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	void Step(float StepTime);
+
+	void RemoveEffectAt(int32 Index);
+
+	// one entry per effect in each array, same index
+	TArray<TWeakObjectPtr<USHealthComponent>> Targets;
+
+	TArray<float> Rates;
+
+	TArray<float> TimeRemaining;
+
+	TArray<TSubclassOf<UDamageType>> DamageTypes;
+
+	TArray<TWeakObjectPtr<AController>> Instigators;
+
+	TArray<TWeakObjectPtr<AActor>> Causers;
+
+	float StepAccumulator;
+};
@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "STargetingSubsystem.generated.h"
+
+class ASCharacter;
+
+/**
+ * Server side target selection for bots.
+ * Live characters are kept in a uniform spatial hash with their team, so nearest hostile queries only look at nearby cells,
+ * and every bot's line of sight checks go out as one async trace batch per frame instead of individual traces per think.
+ */
+UCLASS()
+class SCOUNDRELCORP_API USTargetingSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	USTargetingSubsystem();
+
+	/* Server only. Makes the character show up in queries while it is alive. */
+	void RegisterCharacter(ASCharacter* Character);
+
+	void UnregisterCharacter(ASCharacter* Character);
+
+	/* Server only. Keeps a visible hostile target picked for the character, usually a bot. */
+	void RegisterSeeker(ASCharacter* Seeker);
+
+	void UnregisterSeeker(ASCharacter* Seeker);
+
+	/* Nearest visible hostile of a registered seeker, as of the last line of sight batch */
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "Targeting")
+	ASCharacter* GetCurrentTarget(ASCharacter* Seeker) const;
+
+	/* Nearest live hostile within range, ignores line of sight */
+	UFUNCTION(BlueprintCallable, Category = "Targeting")
+	ASCharacter* FindNearestHostile(ASCharacter* Seeker, float MaxRange) const;
+
+	/* Locations and teams of every live character as of this frame's spatial hash */
+	void GetLiveCharacters(TArray<FVector>& OutLocations, TArray<uint8>& OutTeams) const;
+
+	static bool AreHostile(uint8 TeamA, uint8 TeamB);
+
+	// FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+
+	virtual bool IsTickable() const override;
+
+	virtual TStatId GetStatId() const override;
+
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+
+	struct FTargetEntry
+	{
+		TWeakObjectPtr<ASCharacter> Character;
+
+		FVector Location;
+
+		uint8 TeamNum;
+	};
+
+	struct FSightCheck
+	{
+		TWeakObjectPtr<ASCharacter> Target;
+
+		FTraceHandle TraceHandle;
+	};
+
+	struct FSeekerState
+	{
+		TWeakObjectPtr<ASCharacter> Seeker;
+
+		TWeakObjectPtr<ASCharacter> CurrentTarget;
+
+		/* Issued nearest first, resolved the frame after */
+		TArray<FSightCheck> PendingChecks;
+	};
+
+	static uint8 GetTeamOf(const ASCharacter* Character);
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	void RebuildSpatialHash();
+
+	/* Entry indices of hostiles within range, nearest first */
+	void GatherHostiles(const FVector& Origin, uint8 TeamNum, const ASCharacter* Ignore, float MaxRange, TArray<int32>& OutEntries) const;
+
+	void ResolveSightChecks(FSeekerState& State) const;
+
+	void IssueSightChecks(FSeekerState& State);
+
+	TArray<TWeakObjectPtr<ASCharacter>> RegisteredCharacters;
+
+	/* Rebuilt every frame from the live registered characters */
+	TArray<FTargetEntry> Entries;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	TArray<FSeekerState> Seekers;
+
+	/* Round robin position, seekers are spread over SC.Targeting.UpdateInterval */
+	int32 NextSeekerIndex;
+
+	float SeekerBudget;
+};
@@ -5,12 +5,15 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Particles/ParticleSystem.h"
+#include "SRpcRateLimiter.h"
 #include "SWeapon.generated.h"
 
 class USkeletalMeshComponent;
+class USkeletalMesh;
+class USWeaponDefinition;
 class UDamageType;
-class UParticleSystem;
 class UCameraShake;
+struct FStreamableHandle;
 
 // Contains information of a single hitscan weapon linetrace
 USTRUCT()
@@ -25,8 +28,97 @@ public:
 
 	UPROPERTY()
 	FVector_NetQuantize TraceTo;
+
+	FHitScanTrace()
+		: SurfaceType(SurfaceType_Default)
+		, TraceTo(FVector::ZeroVector)
+	{}
+};
+
+// The last few shots the server traced, so a simulated proxy can replay all the shots of an update and not just the last one
+USTRUCT()
+struct FSHitScanHistory
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Ring of the last shots, shot N lives at N % Traces.Num() so each shot only dirties its own slot */
+	UPROPERTY()
+	TArray<FHitScanTrace> Traces;
+
+	/* Total shots fired, wraps. Proxies replay the difference to the count they saw last. */
+	UPROPERTY()
+	uint16 ShotCount;
+
+	FSHitScanHistory()
+		: ShotCount(0)
+	{
+		// a power of two, so the ring index survives ShotCount wrapping
+		Traces.SetNum(16);
+	}
+};
+
+// The server's spread seed, replicated as one so the owner never pairs a seed with the wrong epoch
+USTRUCT()
+struct FSWeaponSpreadSeed
+{
+	GENERATED_BODY()
+
+public:
+
+	UPROPERTY()
+	int32 Seed;
+
+	/* Bumped with every new seed, shots stamped with an older one are dropped */
+	UPROPERTY()
+	uint8 Epoch;
+
+	FSWeaponSpreadSeed()
+		: Seed(0)
+		, Epoch(0)
+	{}
+};
+
+// A single shot of a batch, stamped where it happened inside the frame rather than where the frame ended
+USTRUCT()
+struct FSWeaponShot
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Synced server time the shot was fired at */
+	UPROPERTY()
+	float ShotTime;
+
+	UPROPERTY()
+	FVector_NetQuantize10 EyeLocation;
+
+	/* Aim before spread, the spread comes from the server's SpreadSeed and ShotIndex */
+	UPROPERTY()
+	FVector_NetQuantizeNormal AimDirection;
+
+	/* SpreadSeed epoch the owner fired this shot under */
+	UPROPERTY()
+	uint8 SpreadEpoch;
+
+	/* Position in the epoch's shot sequence, the server only takes the next one in line */
+	UPROPERTY()
+	int32 ShotIndex;
+
+	FSWeaponShot()
+		: ShotTime(0.0f)
+		, EyeLocation(FVector::ZeroVector)
+		, AimDirection(FVector::ForwardVector)
+		, SpreadEpoch(0)
+		, ShotIndex(0)
+	{}
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnAmmoChangedSignature, ASWeapon*, Weapon, int32, AmmoInMag, int32, TotalAmmo);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnReloadStateChangedSignature, ASWeapon*, Weapon, bool, bReloading);
+
 UCLASS()
 class SCOUNDRELCORP_API ASWeapon : public AActor
 {
@@ -44,23 +136,84 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Components")
 	USkeletalMeshComponent* MeshComp;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	TSubclassOf<UDamageType> DamageType;
+	/* Shared tuning and FX, falls back to the USWeaponDefinition class defaults when unset. Swapped by the inventory when switching weapons. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, ReplicatedUsing=OnRep_WeaponDefinition, Category = "Weapon")
+	USWeaponDefinition* WeaponDefinition;
 
-	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	FName MuzzleSocketName;
+	UFUNCTION()
+	void OnRep_WeaponDefinition();
+
+	virtual void PostLoad() override;
+
+	/* Built by PostLoad from the properties below when a Blueprint has no WeaponDefinition yet */
+	UPROPERTY(Transient)
+	USWeaponDefinition* LegacyDefinition;
+
+	// Tuning and FX from before USWeaponDefinition, only kept so existing Blueprints load with their values.
+	// Defaults match the ones the weapon used to have.
+
+	UPROPERTY()
+	TSubclassOf<UDamageType> DamageType_DEPRECATED;
+
+	UPROPERTY()
+	UParticleSystem* MuzzleEffect_DEPRECATED;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	UParticleSystem* MuzzleEffect;
+	UPROPERTY()
+	UParticleSystem* DefaultImpactEffect_DEPRECATED;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	UParticleSystem* DefaultImpactEffect;
+	UPROPERTY()
+	UParticleSystem* FleshImpactEffect_DEPRECATED;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	UParticleSystem* FleshImpactEffect;
+	UPROPERTY()
+	UParticleSystem* TracerEffect_DEPRECATED;
 
-	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	UParticleSystem* TracerEffect;
+	UPROPERTY()
+	TSubclassOf<UCameraShake> FireCamShake_DEPRECATED;
+
+	UPROPERTY()
+	float BaseDamage_DEPRECATED;
+
+	UPROPERTY()
+	float HeadshotDamageMultiplier_DEPRECATED;
+
+	UPROPERTY()
+	float RateOfFire_DEPRECATED;
+
+	UPROPERTY()
+	float BulletSpread_DEPRECATED;
+
+	UPROPERTY()
+	float ZoomedFOV_DEPRECATED;
+
+	UPROPERTY()
+	float ZoomInterpSpeed_DEPRECATED;
+
+	UPROPERTY()
+	int32 AmmoPerMag_DEPRECATED;
+
+	UPROPERTY()
+	int32 InitialMags_DEPRECATED;
+
+	UPROPERTY()
+	float ReloadTime_DEPRECATED;
+
+	UPROPERTY()
+	float FireRateLimitBurst_DEPRECATED;
+
+	/* Recomputes everything derived from the definition and starts streaming its cosmetics */
+	void ApplyDefinitionSettings();
+
+	void OnCosmeticsLoaded();
+
+	/* The actor's own mesh, put back when the equipped definition doesn't bring one */
+	UPROPERTY(Transient)
+	USkeletalMesh* DefaultWeaponMesh;
+
+	/* Keeps the definition's client bundle loaded while it is equipped */
+	TSharedPtr<FStreamableHandle> CosmeticsHandle;
+
+	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FName MuzzleSocketName;
 
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	FName TracerTargetName;
@@ -71,69 +224,75 @@ protected:
 
 	void PlayImpactEffects(EPhysicalSurface SurfaceType, FVector ImpactPoint);
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-	TSubclassOf<UCameraShake> FireCamShake;
+	float LastFireTime;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-	float BaseDamage;
+	/* Local world time the next shot is due, only meaningful while the trigger is held */
+	float NextShotTime;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-	float HeadshotDamageMultiplier;
-	
-	FTimerHandle TimerHandle_TimeBetweenShots;
+	/* Eye view point at the end of the previous frame, shots inside a frame are interpolated from it */
+	FVector LastEyeLocation;
 
-	float LastFireTime;
+	FQuat LastEyeRotation;
+
+	/* Server time of the last shot accepted from the owning client */
+	float LastServerShotTime;
 
-	/*RPM - Bullets per minute fired by weapon.*/
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-	float RateOfFire;
+	/* Rolled by the server, each shot's spread comes from it and the shot's index so a client can't pick its own */
+	UPROPERTY(Transient, ReplicatedUsing=OnRep_SpreadSeed)
+	FSWeaponSpreadSeed SpreadSeed;
 
-	/*Derived from rate of fire*/
+	UFUNCTION()
+	void OnRep_SpreadSeed();
+
+	/* Next shot index of the current epoch, stamped by the owner and expected by the server */
+	int32 NextShotIndex;
+
+	/* Server only. Starts a new spread sequence under a new epoch. */
+	void ResetSpreadSeed();
+
+	/* Traces, damages and plays FX for one shot. Called on the server and the local client. */
+	void FireShot(const FSWeaponShot& Shot);
+
+	/* Stamps the shots with their spread sequence, fires them locally and sends them to the server in one RPC */
+	void SubmitShots(TArray<FSWeaponShot>& Shots);
+
+	/* Checks a client shot against the server's own view of the shooter, may pull the eye location back in */
+	bool ValidateClientShot(FSWeaponShot& Shot) const;
+
+	/*Derived from the definition's rate of fire*/
 	float TimeBetweenShots;
 
 	UPROPERTY(Transient, Replicated)
 	uint32 bIsFiring : 1;
 
-	/*Bullet spread in degrees*/
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0.0f))
-	float BulletSpread;
-
-	UPROPERTY(ReplicatedUsing=OnRep_HitScanTrace)
-	FHitScanTrace HitScanTrace;
+	UPROPERTY(ReplicatedUsing=OnRep_HitScanHistory)
+	FSHitScanHistory HitScanHistory;
 
 	UFUNCTION()
-    void OnRep_HitScanTrace();
+	void OnRep_HitScanHistory();
 
-	bool CanFire() const;
+	/* HitScanHistory.ShotCount this client has replayed up to */
+	uint16 LastReplayedShotCount;
 
-	//Weapons have their own zoom and zoom speed
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon")
-	float ZoomedFOV;
+	/* Killcam and cosmetic FX for one shot of another player */
+	void ReplayHitScanTrace(const FHitScanTrace& Trace);
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon", meta = (ClampMin = 0.0, ClampMax = 100))
-	float ZoomInterpSpeed;
+	bool CanFire() const;
 
 	// Ammo stuff
-	
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Weapon/Ammo")
-	int32 MaxAmmo;
-	
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon/Ammo")
-	int32 AmmoPerMag;
-
-	UPROPERTY(VisibleAnywhere, Category = "Weapon/Ammo")
-	int32 InitialMags;
 
 	/** Current Total Ammo */
-	UPROPERTY(VisibleAnywhere,Transient, Replicated)
+	UPROPERTY(VisibleAnywhere,Transient, ReplicatedUsing=OnRep_Ammo)
 	int32 CurrentAmmo;
 	/**Current ammo in magazine*/
-	UPROPERTY(VisibleAnywhere,Transient, Replicated)
+	UPROPERTY(VisibleAnywhere,Transient, ReplicatedUsing=OnRep_Ammo)
 	int32 CurrentAmmoInMag;
 
-	UPROPERTY(EditDefaultsOnly, Category = "Weapon/Ammo")
-	float ReloadTime;
-	
+	UFUNCTION()
+	void OnRep_Ammo();
+
+	void SetPendingReload(bool bNewPendingReload);
+
 	FTimerHandle TimerHandle_ReloadTime;
 
 	bool CanReload() const;
@@ -143,14 +302,32 @@ protected:
 	
 	UPROPERTY(Transient, ReplicatedUsing=OnRep_Reload)
 	uint32 bPendingReload : 1;
+
+	// server side budgets for the owning client's RPCs, derived from RateOfFire and ReloadTime
+	FSRpcTokenBucket FireRateLimit;
+
+	FSRpcTokenBucket ReloadRateLimit;
+
+	/* Cheap checks run before any trace, so a modified client can't make the server do work for shots it couldn't take */
+	bool IsServerShotPlausible() const;
 	
 public:	
 
-	//called on server and local client. HitScanTrace used to replicate shot effects to other clients.
+	/* Fired on the server and the owning client, the HUD listens to these instead of polling */
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnAmmoChangedSignature OnAmmoChanged;
+
+	UPROPERTY(BlueprintAssignable, Category = "Events")
+	FOnReloadStateChangedSignature OnReloadStateChanged;
+
+	// Only enabled while the trigger is held, runs the fire accumulator
+	virtual void Tick(float DeltaTime) override;
+
+	//fires a single shot from the current view point. HitScanHistory used to replicate shot effects to other clients.
 	virtual void Fire();
 
 	UFUNCTION(Server, Reliable, WithValidation)
-    void ServerFire();
+	void ServerFireBatch(const TArray<FSWeaponShot>& Shots);
 
 	void StartFire();
 
@@ -167,6 +344,19 @@ public:
 	void StartReload();
 	void StopReload();
 
-	float GetZoomedFOV(){return ZoomedFOV;}
-	float GetZoomSpeed(){return ZoomInterpSpeed;}
+	const USWeaponDefinition* GetDefinition() const;
+
+	/* The assigned definition itself, null when running on the class defaults */
+	USWeaponDefinition* GetWeaponDefinition() const { return WeaponDefinition; }
+
+	/* Server only. Switches this actor over to another weapon without respawning it. */
+	void EquipDefinition(USWeaponDefinition* NewDefinition, int32 NewCurrentAmmo, int32 NewCurrentAmmoInMag);
+
+	int32 GetCurrentAmmo() const { return CurrentAmmo; }
+	int32 GetCurrentAmmoInMag() const { return CurrentAmmoInMag; }
+
+	bool IsReloading() const { return bPendingReload; }
+
+	float GetZoomedFOV() const;
+	float GetZoomSpeed() const;
 };
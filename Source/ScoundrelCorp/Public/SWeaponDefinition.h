@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SWeaponDefinition.generated.h"
+
+class UDamageType;
+class UParticleSystem;
+class UCameraShake;
+class USkeletalMesh;
+struct FStreamableHandle;
+
+/**
+ * Shared, immutable tuning and FX for a weapon. Every weapon instance points at one of these instead of carrying its own copy.
+ * FX and camera shakes are soft references in the "Client" bundle, so they are loaded asynchronously and never on dedicated servers.
+ */
+UCLASS(BlueprintType)
+class SCOUNDRELCORP_API USWeaponDefinition : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	USWeaponDefinition();
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	/* Loads the Client bundle through the asset manager. Returns nothing on dedicated servers. */
+	TSharedPtr<FStreamableHandle> LoadCosmetics(const UObject* WorldContextObject) const;
+
+	static const FName CosmeticBundleName;
+
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TSubclassOf<UDamageType> DamageType;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float BaseDamage;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float HeadshotDamageMultiplier;
+
+	/*RPM - Bullets per minute fired by weapon.*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = 1.0f))
+	float RateOfFire;
+
+	/*Bullet spread in degrees*/
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = 0.0f))
+	float BulletSpread;
+
+	//Weapons have their own zoom and zoom speed
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float ZoomedFOV;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (ClampMin = 0.0, ClampMax = 100))
+	float ZoomInterpSpeed;
+
+	/* Extra fire RPCs the server's budget lets through back to back, covers batches bunched up by network jitter. Shots inside a batch are held to the cadence instead. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Network", meta = (ClampMin = 1.0f))
+	float FireRateLimitBurst;
+
+	// Ammo stuff
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Ammo")
+	int32 AmmoPerMag;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Ammo")
+	int32 InitialMags;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Ammo")
+	float ReloadTime;
+
+	// Cosmetics, client only
+
+	/* Swapped onto the weapon actor when this definition is equipped, leave empty to keep the actor's own mesh */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<USkeletalMesh> WeaponMesh;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UParticleSystem> MuzzleEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UParticleSystem> DefaultImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UParticleSystem> FleshImpactEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftObjectPtr<UParticleSystem> TracerEffect;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon/Effects", meta = (AssetBundles = "Client"))
+	TSoftClassPtr<UCameraShake> FireCamShake;
+
+	float GetTimeBetweenShots() const { return 60.0f / RateOfFire; }
+};
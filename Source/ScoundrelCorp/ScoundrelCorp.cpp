@@ -2,5 +2,74 @@
 
 #include "ScoundrelCorp.h"
 #include "Modules/ModuleManager.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+DEFINE_LOG_CATEGORY(LogScoundrelCorp);
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ScoundrelCorp, "ScoundrelCorp" );
+
+namespace
+{
+	// blueprints count as ours when their first native class is
+	bool IsScoundrelCorpClass(const UClass* Class)
+	{
+		while (Class && !Class->HasAnyClassFlags(CLASS_Native))
+		{
+			Class = Class->GetSuperClass();
+		}
+
+		return Class && Class->GetOutermost()->GetFName() == TEXT("/Script/ScoundrelCorp");
+	}
+
+	void ListTickingActors(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		int32 NumActors = 0;
+		int32 NumTickingActors = 0;
+		int32 NumTickingComponents = 0;
+		TMap<FName, int32> TickingPerClass;
+
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			AActor* Actor = *It;
+			if (!IsScoundrelCorpClass(Actor->GetClass()))
+			{
+				continue;
+			}
+
+			NumActors++;
+
+			if (Actor->PrimaryActorTick.IsTickFunctionRegistered() && Actor->IsActorTickEnabled())
+			{
+				NumTickingActors++;
+				TickingPerClass.FindOrAdd(Actor->GetClass()->GetFName())++;
+			}
+
+			for (UActorComponent* Component : Actor->GetComponents())
+			{
+				if (Component && Component->PrimaryComponentTick.IsTickFunctionRegistered() && Component->IsComponentTickEnabled())
+				{
+					NumTickingComponents++;
+				}
+			}
+		}
+
+		UE_LOG(LogScoundrelCorp, Display, TEXT("%d of %d ScoundrelCorp actors ticking (%d ticking components on them)"), NumTickingActors, NumActors, NumTickingComponents);
+
+		for (const TPair<FName, int32>& ClassCount : TickingPerClass)
+		{
+			UE_LOG(LogScoundrelCorp, Display, TEXT("  %s: %d"), *ClassCount.Key.ToString(), ClassCount.Value);
+		}
+	}
+}
+
+FAutoConsoleCommandWithWorldAndArgs CmdListTickingActors(
+	TEXT("SC.ListTickingActors"),
+	TEXT("Logs how many ScoundrelCorp actors (and their components) are registered and enabled for tick"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&ListTickingActors));
@@ -7,4 +7,8 @@
 #define SURFACE_FLESHDEFAULT	SurfaceType1
 #define SURFACE_FLESHVULNERABLE SurfaceType2
 
-#define COLLISION_WEAPON		ECC_GameTraceChannel1
\ No newline at end of file
+#define COLLISION_WEAPON		ECC_GameTraceChannel1
+
+DECLARE_LOG_CATEGORY_EXTERN(LogScoundrelCorp, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("ScoundrelCorp"), STATGROUP_ScoundrelCorp, STATCAT_Advanced);